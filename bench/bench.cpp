@@ -0,0 +1,355 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "types.hpp"
+#include "constants.hpp"
+#include "loader.hpp"
+#include "pdf_loader.hpp"
+#include "substring_search.hpp"
+#include "regex.hpp"
+
+#include <regex>
+
+static constexpr i32 syntheticDocumentCount = 4;
+static constexpr i32 syntheticPageCount = 1000;
+static constexpr i32 syntheticBlocksPerPage = 12;
+static constexpr i32 syntheticLinesPerBlock = 6;
+static constexpr i32 syntheticWordsPerLine = 10;
+
+static constexpr i32 substringRepetitions = 20;
+
+static const char* const substringSearches[] = { "e", "the", "fireball", "saving throw", "Dexterity saving throw", "zqxj" };
+
+static constexpr i32 regexRepetitions = 3;
+
+static const char* const regexSearches[] = { "fire\\w*", "\\bDC \\d+", "(saving|throw)s?", "[A-Z][a-z]+ity", "zq+xj" };
+
+static const char* const syntheticWords[] = {
+    "the", "fireball", "saving", "throw", "Strength", "Dexterity", "DC", "15", "grappled",
+    "prone", "restrained", "spell", "slot", "creature", "within", "range", "naïve", "über"
+};
+
+template<typename F>
+static f64 millisecondsTaken(const F& f)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    f();
+
+    return chrono::duration<f64, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Built the way the PDF loader builds pages, for measuring everything but MuPDF without needing a document
+static Document syntheticDocument(u32 seed)
+{
+    mt19937 engine(seed);
+
+    Document document;
+    document.reserve(syntheticPageCount);
+
+    string text;
+
+    for (i32 pageIndex = 0; pageIndex < syntheticPageCount; pageIndex++)
+    {
+        Page page;
+        page.reserve(syntheticBlocksPerPage);
+
+        for (i32 blockIndex = 0; blockIndex < syntheticBlocksPerPage; blockIndex++)
+        {
+            text.clear();
+
+            for (i32 line = 0; line < syntheticLinesPerBlock; line++)
+            {
+                for (i32 word = 0; word < syntheticWordsPerLine; word++)
+                {
+                    text += syntheticWords[engine() % size(syntheticWords)];
+                    text += word + 1 < syntheticWordsPerLine ? ' ' : '\n';
+                }
+            }
+
+            f64 top = blockIndex * 64;
+
+            page.add(Block(0, 480, top, top + 60, text, page.allocator()));
+        }
+
+        document.add(move(page));
+    }
+
+    return document;
+}
+
+// Loads the documents given, or several synthetic thousand-page ones, then closes them all at once like quitting does
+static void benchmarkLoad(const vector<filesystem::path>& paths)
+{
+    vector<Document> documents;
+
+    f64 loadTime = millisecondsTaken([&]() -> void {
+        if (paths.empty())
+        {
+            for (i32 i = 0; i < syntheticDocumentCount; i++)
+            {
+                documents.push_back(syntheticDocument(i));
+                documents.back().generateGrid();
+            }
+        }
+        else
+        {
+            for (const filesystem::path& path : paths)
+            {
+                documents.push_back(loadDocument(path));
+            }
+        }
+    });
+
+    size_t pageCount = 0;
+
+    for (const Document& document : documents)
+    {
+        pageCount += document.pages().size();
+    }
+
+    f64 closeTime = millisecondsTaken([&]() -> void {
+        documents.clear();
+    });
+
+    cout << format("load: {} pages in {:.1f} ms", pageCount, loadTime) << endl;
+    cout << format("close: {} pages in {:.1f} ms", pageCount, closeTime) << endl;
+}
+
+// Extracts the documents given with the text-only device and then the structured text one, without building anything for display or search
+static void benchmarkExtract(const vector<filesystem::path>& paths)
+{
+    for (bool structuredText : { false, true })
+    {
+        if (structuredText)
+        {
+            setenv(extractorVariable, structuredTextExtractor, 1);
+        }
+        else
+        {
+            unsetenv(extractorVariable);
+        }
+
+        size_t pageCount = 0;
+        size_t textSize = 0;
+
+        f64 extractTime = millisecondsTaken([&]() -> void {
+            for (const filesystem::path& path : paths)
+            {
+                Document document = loadPDF(path);
+
+                pageCount += document.pages().size();
+                textSize += document.text().size();
+            }
+        });
+
+        cout << format(
+            "extract ({}): {} pages, {} KiB of text in {:.1f} ms, {:.1f} pages/s",
+            structuredText ? "stext" : "text",
+            pageCount,
+            textSize / 1024,
+            extractTime,
+            pageCount / (extractTime / 1000)
+        ) << endl;
+    }
+
+    unsetenv(extractorVariable);
+}
+
+// The extracted text of the documents given, or of a synthetic one
+static string benchmarkText(const vector<filesystem::path>& paths)
+{
+    if (paths.empty())
+    {
+        return syntheticDocument(0).text();
+    }
+
+    string text;
+
+    for (const filesystem::path& path : paths)
+    {
+        text += loadPDF(path).text();
+    }
+
+    return text;
+}
+
+template<typename F>
+static size_t countMatches(string_view text, string_view search, const F& find)
+{
+    size_t count = 0;
+
+    for (size_t offset = find(text, search, 0); offset != string_view::npos; offset = find(text, search, offset + 1))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+// Counts every match of a few searches in the extracted text with the vectorized kernel, string::find and memmem
+static void benchmarkSubstring(const vector<filesystem::path>& paths)
+{
+    string text = benchmarkText(paths);
+
+    auto kernel = [](string_view s, string_view search, size_t offset) -> size_t {
+        return findSubstring(s, search, offset);
+    };
+
+    auto standard = [](string_view s, string_view search, size_t offset) -> size_t {
+        return s.find(search, offset);
+    };
+
+    auto memoryMemory = [](string_view s, string_view search, size_t offset) -> size_t {
+        const void* match = memmem(s.data() + offset, s.size() - offset, search.data(), search.size());
+
+        return match ? static_cast<const char*>(match) - s.data() : string_view::npos;
+    };
+
+    cout << format("substring: {} KiB of text, {} repetitions", text.size() / 1024, substringRepetitions) << endl;
+
+    for (const char* search : substringSearches)
+    {
+        size_t kernelCount = 0;
+        size_t standardCount = 0;
+        size_t memoryMemoryCount = 0;
+
+        f64 kernelTime = millisecondsTaken([&]() -> void {
+            for (i32 i = 0; i < substringRepetitions; i++)
+            {
+                kernelCount = countMatches(text, search, kernel);
+            }
+        });
+
+        f64 standardTime = millisecondsTaken([&]() -> void {
+            for (i32 i = 0; i < substringRepetitions; i++)
+            {
+                standardCount = countMatches(text, search, standard);
+            }
+        });
+
+        f64 memoryMemoryTime = millisecondsTaken([&]() -> void {
+            for (i32 i = 0; i < substringRepetitions; i++)
+            {
+                memoryMemoryCount = countMatches(text, search, memoryMemory);
+            }
+        });
+
+        if (kernelCount != standardCount || kernelCount != memoryMemoryCount)
+        {
+            cerr << format("Match counts for '{}' differ: {}, {}, {}", search, kernelCount, standardCount, memoryMemoryCount) << endl;
+        }
+
+        cout << format(
+            "  '{}': {} matches, kernel {:.1f} ms, string::find {:.1f} ms, memmem {:.1f} ms",
+            search,
+            kernelCount,
+            kernelTime,
+            standardTime,
+            memoryMemoryTime
+        ) << endl;
+    }
+}
+
+// Finds every match of a few expressions in the extracted text with the DFA engine and std::regex, which prefers leftmost-first matches so counts can differ
+static void benchmarkRegex(const vector<filesystem::path>& paths)
+{
+    string text = benchmarkText(paths);
+
+    cout << format("regex: {} KiB of text, {} repetitions", text.size() / 1024, regexRepetitions) << endl;
+
+    for (const char* search : regexSearches)
+    {
+        Regex regex(search, false);
+        std::regex standardRegex(search, std::regex::ECMAScript | std::regex::multiline);
+
+        size_t count = 0;
+        size_t standardCount = 0;
+
+        f64 time = millisecondsTaken([&]() -> void {
+            for (i32 i = 0; i < regexRepetitions; i++)
+            {
+                count = regex.find(text, 0, text.size()).size();
+            }
+        });
+
+        f64 standardTime = millisecondsTaken([&]() -> void {
+            for (i32 i = 0; i < regexRepetitions; i++)
+            {
+                standardCount = distance(sregex_iterator(text.begin(), text.end(), standardRegex), sregex_iterator());
+            }
+        });
+
+        cout << format(
+            "  '{}': DFA {} matches in {:.1f} ms, std::regex {} matches in {:.1f} ms",
+            search,
+            count,
+            time,
+            standardCount,
+            standardTime
+        ) << endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    // Extraction pools start workers from whichever executable they run in
+    if (argc == 3 && string(argv[1]) == extractionWorkerOption)
+    {
+        runExtractionWorker(argv[2]);
+        return 0;
+    }
+
+    if (argc < 2)
+    {
+        cerr << format("Usage: {} load [files...]", argv[0]) << endl;
+        cerr << format("       {} extract files...", argv[0]) << endl;
+        cerr << format("       {} substring [files...]", argv[0]) << endl;
+        cerr << format("       {} regex [files...]", argv[0]) << endl;
+        return 1;
+    }
+
+    string benchmark = argv[1];
+    vector<filesystem::path> paths(argv + 2, argv + argc);
+
+    if (benchmark == "load")
+    {
+        benchmarkLoad(paths);
+    }
+    else if (benchmark == "extract" && !paths.empty())
+    {
+        benchmarkExtract(paths);
+    }
+    else if (benchmark == "substring")
+    {
+        benchmarkSubstring(paths);
+    }
+    else if (benchmark == "regex")
+    {
+        benchmarkRegex(paths);
+    }
+    else
+    {
+        cerr << format("Unknown benchmark '{}'.", benchmark) << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "aho_corasick.hpp"
+
+AhoCorasick::AhoCorasick(const vector<string>& patterns)
+{
+    states.push_back({ {}, -1, -1 });
+    states.front().next.fill(-1);
+
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+        const string& pattern = patterns.at(i);
+
+        patternSizes.push_back(pattern.size());
+
+        if (pattern.empty())
+        {
+            continue;
+        }
+
+        i32 state = 0;
+
+        for (u8 c : pattern)
+        {
+            if (states.at(state).next.at(c) < 0)
+            {
+                states.at(state).next.at(c) = states.size();
+                states.push_back({ {}, -1, -1 });
+                states.back().next.fill(-1);
+            }
+
+            state = states.at(state).next.at(c);
+        }
+
+        if (states.at(state).pattern < 0)
+        {
+            states.at(state).pattern = i;
+        }
+    }
+
+    // Breadth first so every state's failure is complete before its children need it
+    vector<i32> failures(states.size(), 0);
+    deque<i32> queue;
+
+    for (i32& next : states.front().next)
+    {
+        if (next < 0)
+        {
+            next = 0;
+        }
+        else
+        {
+            queue.push_back(next);
+        }
+    }
+
+    while (!queue.empty())
+    {
+        i32 state = queue.front();
+        queue.pop_front();
+
+        i32 failure = failures.at(state);
+
+        states.at(state).output = states.at(failure).pattern >= 0 ? failure : states.at(failure).output;
+
+        for (size_t c = 0; c < 256; c++)
+        {
+            i32& next = states.at(state).next.at(c);
+
+            if (next < 0)
+            {
+                next = states.at(failure).next.at(c);
+            }
+            else
+            {
+                failures.at(next) = states.at(failure).next.at(c);
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+vector<TextSpan> AhoCorasick::find(string_view text, size_t start, size_t end, vector<i32>* patterns) const
+{
+    vector<pair<TextSpan, i32>> matches;
+
+    i32 state = 0;
+
+    for (size_t i = start; i < end; i++)
+    {
+        state = states[state].next[static_cast<u8>(text[i])];
+
+        i32 match = states[state].pattern >= 0 ? state : states[state].output;
+
+        while (match >= 0)
+        {
+            i32 pattern = states[match].pattern;
+            size_t size = patternSizes[pattern];
+
+            matches.push_back({ { i + 1 - size, size }, pattern });
+
+            match = states[match].output;
+        }
+    }
+
+    sort(matches.begin(), matches.end(), [](const pair<TextSpan, i32>& a, const pair<TextSpan, i32>& b) -> bool {
+        return a.first.offset != b.first.offset ? a.first.offset < b.first.offset : a.first.size > b.first.size;
+    });
+
+    vector<TextSpan> hits;
+    hits.reserve(matches.size());
+    patterns->clear();
+    patterns->reserve(matches.size());
+
+    for (const auto& [ hit, pattern ] : matches)
+    {
+        hits.push_back(hit);
+        patterns->push_back(pattern);
+    }
+
+    return hits;
+}
@@ -0,0 +1,49 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+
+// Finds every occurrence of several patterns at once in a single pass over the text
+class AhoCorasick
+{
+public:
+    AhoCorasick(const vector<string>& patterns);
+
+    /*
+     * Every match in text between start and end, ordered by offset and then longest first, along with
+     * the index of the pattern each one is of. Patterns that are repeated only report the first.
+     */
+    vector<TextSpan> find(string_view text, size_t start, size_t end, vector<i32>* patterns) const;
+
+private:
+    struct State
+    {
+        // Transitions for every byte with failures already followed, so each byte is one lookup
+        array<i32, 256> next;
+        // The pattern ending here, or -1
+        i32 pattern;
+        // The nearest state reached by failing from here that has a pattern, or -1
+        i32 output;
+    };
+
+    vector<State> states;
+    vector<size_t> patternSizes;
+};
@@ -20,50 +20,42 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "charwise.hpp"
 #include "whitespace.hpp"
 
-Block::Block(f64 left, f64 right, f64 top, f64 bottom, const string& text)
+Block::Block(f64 left, f64 right, f64 top, f64 bottom, string_view text, const allocator_type& allocator)
     : _left(left)
     , _right(right)
     , _top(top)
     , _bottom(bottom)
-    , _text(trimWhitespace(text))
+    , _text(trimWhitespace(text), allocator)
 {
 
 }
 
-void Block::adjustBlockOffset(float x, float y)
+Block::Block(const Block& rhs, const allocator_type& allocator)
+    : _left(rhs._left)
+    , _right(rhs._right)
+    , _top(rhs._top)
+    , _bottom(rhs._bottom)
+    , _text(rhs._text, allocator)
 {
-    _left -= x;
-    _right -= x;
-    _top -= y;
-    _bottom -= y;
+
 }
 
-vector<SearchResultLocation> Block::search(const string& search) const
+Block::Block(Block&& rhs, const allocator_type& allocator)
+    : _left(rhs._left)
+    , _right(rhs._right)
+    , _top(rhs._top)
+    , _bottom(rhs._bottom)
+    , _text(move(rhs._text), allocator)
 {
-    vector<SearchResultLocation> results;
 
-    if (search.empty())
-    {
-        return results;
-    }
-
-    size_t offset = 0;
-
-    while (true)
-    {
-        size_t index = charwiseFind(_text, search, offset);
-
-        if (index == string::npos)
-        {
-            break;
-        }
-
-        offset = index + charwiseSize(search);
-
-        results.push_back(SearchResultLocation("", 0, 0, index));
-    }
+}
 
-    return results;
+void Block::adjustBlockOffset(float x, float y)
+{
+    _left -= x;
+    _right -= x;
+    _top -= y;
+    _bottom -= y;
 }
 
 i32 Block::width() const
@@ -125,7 +117,7 @@ f64 Block::bottom() const
     return _bottom;
 }
 
-const string& Block::text() const
+const pmr::string& Block::text() const
 {
     return _text;
 }
@@ -156,25 +148,43 @@ vector<vector<string>> Block::grid() const
 
 tuple<i32, i32> Block::locateSearchInGrid(const SearchResultLocation& location) const
 {
-    vector<string> chars = splitUTF8(_text);
+    return locateInGrid({ location.characterIndex }).front();
+}
+
+vector<tuple<i32, i32>> Block::locateInGrid(const vector<i32>& characterIndices) const
+{
+    vector<tuple<i32, i32>> positions;
+    positions.reserve(characterIndices.size());
 
     i32 x = 0;
     i32 y = 0;
+    i32 characterIndex = 0;
+    size_t offset = 0;
 
-    for (size_t i = 0; i < location.characterIndex; i++)
+    for (i32 index : characterIndices)
     {
-        const string& c = chars.at(i);
-
-        if (c == "\n")
+        for (; characterIndex < index; characterIndex++)
         {
-            x = 0;
-            y++;
-        }
-        else
-        {
-            x++;
+            if (_text.at(offset) == '\n')
+            {
+                x = 0;
+                y++;
+            }
+            else
+            {
+                x++;
+            }
+
+            offset++;
+
+            while (offset < _text.size() && !isPrimaryByte(_text[offset]))
+            {
+                offset++;
+            }
         }
+
+        positions.push_back({ x, y });
     }
 
-    return { x, y };
+    return positions;
 }
@@ -24,11 +24,18 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 class Block
 {
 public:
-    Block(f64 left, f64 right, f64 top, f64 bottom, const string& text);
+    typedef pmr::polymorphic_allocator<> allocator_type;
 
-    void adjustBlockOffset(float x, float y);
+    Block(f64 left, f64 right, f64 top, f64 bottom, string_view text, const allocator_type& allocator = {});
+    Block(const Block& rhs) = default;
+    Block(Block&& rhs) = default;
+    Block(const Block& rhs, const allocator_type& allocator);
+    Block(Block&& rhs, const allocator_type& allocator);
+
+    Block& operator=(const Block& rhs) = default;
+    Block& operator=(Block&& rhs) = default;
 
-    vector<SearchResultLocation> search(const string& search) const;
+    void adjustBlockOffset(float x, float y);
 
     i32 width() const;
     i32 height() const;
@@ -36,15 +43,17 @@ public:
     f64 right() const;
     f64 top() const;
     f64 bottom() const;
-    const string& text() const;
+    const pmr::string& text() const;
 
     vector<vector<string>> grid() const;
     tuple<i32, i32> locateSearchInGrid(const SearchResultLocation& location) const;
+    // Grid positions of the characters at each index, which must be ascending, in one pass over the text
+    vector<tuple<i32, i32>> locateInGrid(const vector<i32>& characterIndices) const;
 
 private:
     f64 _left;
     f64 _right;
     f64 _top;
     f64 _bottom;
-    string _text;
+    pmr::string _text;
 };
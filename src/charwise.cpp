@@ -24,7 +24,139 @@ bool isPrimaryByte(char c)
     return (c & 0xc0) != 0x80;
 }
 
-vector<string> splitUTF8(const string& s)
+bool endsMidCharacter(string_view s)
+{
+    if (s.empty())
+    {
+        return false;
+    }
+
+    size_t offset = lastCharacterOffset(s);
+
+    u8 c = s[offset];
+
+    size_t expected = 1;
+
+    if ((c & 0xe0) == 0xc0)
+    {
+        expected = 2;
+    }
+    else if ((c & 0xf0) == 0xe0)
+    {
+        expected = 3;
+    }
+    else if ((c & 0xf8) == 0xf0)
+    {
+        expected = 4;
+    }
+
+    return s.size() - offset < expected;
+}
+
+size_t lastCharacterOffset(string_view s)
+{
+    size_t offset = s.size();
+
+    while (offset > 0)
+    {
+        offset--;
+
+        if (isPrimaryByte(s[offset]))
+        {
+            break;
+        }
+    }
+
+    return offset;
+}
+
+void appendUTF8(string& s, i32 c)
+{
+    if (c < 0)
+    {
+        return;
+    }
+    else if (c <= 0x7f)
+    {
+        s += static_cast<char>(c);
+    }
+    else if (c <= 0x7ff)
+    {
+        s += 0xc0 | (c >> 6);
+        s += 0x80 | (c & 0x3f);
+    }
+    else if (c <= 0xffff)
+    {
+        s += 0xe0 | (c >> 12);
+        s += 0x80 | ((c >> 6) & 0x3f);
+        s += 0x80 | (c & 0x3f);
+    }
+    else if (c <= 0x10ffff)
+    {
+        s += 0xf0 | (c >> 18);
+        s += 0x80 | ((c >> 12) & 0x3f);
+        s += 0x80 | ((c >> 6) & 0x3f);
+        s += 0x80 | (c & 0x3f);
+    }
+}
+
+i32 decodeUTF8(string_view s, size_t offset, size_t* size)
+{
+    u8 c = s[offset];
+
+    i32 codepoint;
+    size_t length;
+
+    if (c <= 0x7f)
+    {
+        *size = 1;
+        return c;
+    }
+    else if ((c & 0xe0) == 0xc0)
+    {
+        codepoint = c & 0x1f;
+        length = 2;
+    }
+    else if ((c & 0xf0) == 0xe0)
+    {
+        codepoint = c & 0x0f;
+        length = 3;
+    }
+    else if ((c & 0xf8) == 0xf0)
+    {
+        codepoint = c & 0x07;
+        length = 4;
+    }
+    else
+    {
+        *size = 1;
+        return -1;
+    }
+
+    if (offset + length > s.size())
+    {
+        *size = 1;
+        return -1;
+    }
+
+    for (size_t i = 1; i < length; i++)
+    {
+        u8 next = s[offset + i];
+
+        if ((next & 0xc0) != 0x80)
+        {
+            *size = 1;
+            return -1;
+        }
+
+        codepoint = (codepoint << 6) | (next & 0x3f);
+    }
+
+    *size = length;
+    return codepoint;
+}
+
+vector<string> splitUTF8(string_view s)
 {
     vector<string> chars;
 
@@ -55,21 +187,56 @@ string joinUTF8(const vector<string>& chars)
     return s;
 }
 
-size_t charwiseSize(const string& s)
+string joinUTF8(const pmr::vector<pmr::string>& chars)
+{
+    string s;
+
+    for (const pmr::string& c : chars)
+    {
+        s += c;
+    }
+
+    return s;
+}
+
+size_t charwiseSize(string_view s)
+{
+    return count_if(s.begin(), s.end(), isPrimaryByte);
+}
+
+size_t charwiseOffset(string_view s, size_t index)
 {
-    return splitUTF8(s).size();
+    size_t count = 0;
+
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (!isPrimaryByte(s[i]))
+        {
+            continue;
+        }
+
+        if (count == index)
+        {
+            return i;
+        }
+
+        count++;
+    }
+
+    return s.size();
 }
 
-string charwiseSubstring(const string& s, size_t offset, size_t size)
+string charwiseSubstring(string_view s, size_t offset, size_t size)
 {
-    vector<string> chars = splitUTF8(s);
+    size_t start = charwiseOffset(s, offset);
+    size_t end = start + charwiseOffset(s.substr(start), size);
 
-    return joinUTF8({ chars.begin() + offset, chars.begin() + offset + size });
+    return string(s.substr(start, end - start));
 }
 
-size_t charwiseFind(const string& s, const string& search, size_t offset)
+size_t charwiseFind(string_view s, string_view search, size_t offset)
 {
-    size_t index = s.find(search, charwiseSubstring(s, 0, offset).size());
+    size_t index = s.find(search, charwiseOffset(s, offset));
 
     if (index == string::npos)
     {
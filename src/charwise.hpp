@@ -21,8 +21,18 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "types.hpp"
 
 bool isPrimaryByte(char c);
-vector<string> splitUTF8(const string& s);
+// Whether the last character is missing some of its continuation bytes
+bool endsMidCharacter(string_view s);
+// Byte offset of the last character, or zero for an empty string
+size_t lastCharacterOffset(string_view s);
+void appendUTF8(string& s, i32 c);
+// Code point of the character at offset and its size in bytes, or -1 for a malformed sequence one byte long
+i32 decodeUTF8(string_view s, size_t offset, size_t* size);
+vector<string> splitUTF8(string_view s);
 string joinUTF8(const vector<string>& chars);
-size_t charwiseSize(const string& s);
-string charwiseSubstring(const string& s, size_t offset, size_t size);
-size_t charwiseFind(const string& s, const string& search, size_t offset);
+string joinUTF8(const pmr::vector<pmr::string>& chars);
+size_t charwiseSize(string_view s);
+// Byte offset of the character at the given index, or the size of the string if past the end
+size_t charwiseOffset(string_view s, size_t index);
+string charwiseSubstring(string_view s, size_t offset, size_t size);
+size_t charwiseFind(string_view s, string_view search, size_t offset);
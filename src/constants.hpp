@@ -26,9 +26,66 @@ static constexpr u32 minorVersion = 3;
 static constexpr u32 patchVersion = 3;
 
 static constexpr size_t maxSearchLength = 1024;
+static constexpr const char* regexSearchPrefix = "re:";
+static constexpr const char* fuzzySearchPrefix = "~";
+static constexpr i32 defaultFuzzyDistance = 1;
+static constexpr char multiplePatternSeparator = '|';
+// Written before the separator to search for it literally
+static constexpr char searchEscape = '\\';
+// Results record the pattern they matched in a byte
+static constexpr size_t maxSearchPatterns = 256;
+static constexpr char phraseSearchQuote = '"';
+static constexpr i32 maxRegexRepetition = 1000;
+static constexpr size_t maxRegexInstructions = 100000;
+static constexpr size_t maxRegexStates = 4096;
+// Classes wider than this match their members as-is rather than each one's normalized form
+static constexpr i32 maxNormalizedClassRange = 0x3000;
+// How long key presses are waited for while a search is running before its results are published
+static constexpr i32 searchPollInterval = 50;
+// Results of searches in each document kept for when they are run again, up to a total size
+static constexpr size_t searchCacheSize = 256;
+static constexpr size_t searchCacheByteLimit = 64 * 1024 * 1024;
+static constexpr size_t searchHistorySize = 100;
 static constexpr size_t maxPageNumberLength = 16;
 
 static constexpr i32 blockVerticalSpacer = 1;
 static constexpr i32 blockHorizontalSpacer = 4;
 
+static constexpr size_t documentArenaInitialSize = 64 * 1024;
+static constexpr size_t pageArenaInitialSize = 16 * 1024;
+
+static constexpr const char* storeSizeVariable = "NPDFR_STORE_SIZE";
+static constexpr size_t defaultStoreSize = 256 * 1024 * 1024;
+// MuPDF takes a size of zero as no limit at all
+static constexpr size_t minStoreSize = 16 * 1024 * 1024;
+static constexpr i32 storeScrubInterval = 64;
+static constexpr const char* extractorVariable = "NPDFR_EXTRACTOR";
+static constexpr const char* structuredTextExtractor = "stext";
+static constexpr const char* workersVariable = "NPDFR_WORKERS";
+// Not for users, starts an extraction worker reading page indices from stdin and writing pages to stdout
+static constexpr const char* extractionWorkerOption = "--extraction-worker";
+static constexpr const char* selfExecutablePath = "/proc/self/exe";
+static constexpr const char* grepOption = "--grep";
+static constexpr const char* caseModeVariable = "NPDFR_SEARCH_CASE";
+static constexpr const char* smartCaseMode = "smart";
+static constexpr const char* ignoreCaseMode = "ignore";
+static constexpr i32 extractionAttempts = 2;
+static constexpr chrono::milliseconds extractionTimeout(30000);
+
+static constexpr const char* cacheHomeVariable = "XDG_CACHE_HOME";
+static constexpr const char* homeVariable = "HOME";
+static constexpr const char* defaultCacheDirectory = ".cache";
+static constexpr const char* indexFileExtension = ".index";
+// Saved indices unused for longer than this, or the ones used longest ago past the total size, are removed
+static constexpr chrono::hours indexCacheMaxAge(24 * 30);
+static constexpr u64 indexCacheSizeLimit = 1024ull * 1024 * 1024;
+// Temporary files older than this belong to saves that will never finish
+static constexpr chrono::minutes indexTemporaryFileAge(10);
+// Seven characters and a null byte, filling the header's magic field
+static constexpr const char* indexFileMagic = "npdfrsa";
+// Bump whenever the suffix array or the search text it is built over changes
+static constexpr u32 indexFileVersion = 3;
+static constexpr u64 hashOffsetBasis = 0xcbf29ce484222325;
+static constexpr u64 hashPrime = 0x100000001b3;
+
 static constexpr string pdfExtension = ".pdf";
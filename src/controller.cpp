@@ -20,15 +20,28 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "constants.hpp"
 #include "charwise.hpp"
 #include "loader.hpp"
+#include "search_query.hpp"
 
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <ncurses.h>
 
+// The first pattern of a search is blue like a single pattern's results and the rest cycle through other colours
+static i32 highlightPair(i32 pattern)
+{
+    return pattern == 0 ? 1 : 3 + (pattern - 1) % 4;
+}
+
 Controller::Controller()
     : displayOpen(false)
     , quit(false)
+    , searchQuery(parseSearch(""))
+    , searchError("")
     , searchForwards(true)
+    , caseMode(caseModeFromEnvironment())
+    , focusedPattern(-1)
+    // Leaves a core for the interface thread
+    , searchPool(max(thread::hardware_concurrency(), 2u) - 1)
 {
 
 }
@@ -40,7 +53,13 @@ Controller::~Controller()
 
 void Controller::open(const filesystem::path& path)
 {
-    documents.insert_or_assign(path, loadDocument(path));
+    // Tasks of a cancelled search may still hold on to the document being replaced
+    cancelSearch();
+    searchPool.wait();
+
+    documents.erase(path);
+    documents.emplace(path, loadDocument(path));
+    searchCache.erase(path);
     views.insert_or_assign(path, DocumentView());
 
     activeDocumentName = path;
@@ -62,6 +81,10 @@ void Controller::openDisplay()
 
         init_pair(1, COLOR_BLUE, -1);
         init_pair(2, COLOR_RED, -1);
+        init_pair(3, COLOR_GREEN, -1);
+        init_pair(4, COLOR_YELLOW, -1);
+        init_pair(5, COLOR_MAGENTA, -1);
+        init_pair(6, COLOR_CYAN, -1);
 
         displayOpen = true;
     }
@@ -126,6 +149,11 @@ void Controller::drawScreen() const
         pages()
     );
 
+    if (activePage().failed())
+    {
+        prompt += " [extraction failed]";
+    }
+
     if (!search.empty())
     {
         prompt += format(
@@ -134,6 +162,39 @@ void Controller::drawScreen() const
             activeView().searchResultIndex + 1,
             searchResults().size()
         );
+
+        if (caseMode == CaseMode::Smart)
+        {
+            prompt += " [smart case]";
+        }
+        else if (caseMode == CaseMode::Ignore)
+        {
+            prompt += " [ignore case]";
+        }
+
+        if (!searchError.empty())
+        {
+            prompt += format(" [{}]", searchError);
+        }
+        else if (searchQuery.kind == SearchKind::Multiple && focusedPattern >= 0 && focusedPattern < static_cast<i32>(searchQuery.patterns.size()))
+        {
+            prompt += format(" [{}]", searchQuery.patterns.at(focusedPattern));
+        }
+
+        if (searchJob)
+        {
+            prompt += " [searching]";
+        }
+    }
+
+    if (!message.empty())
+    {
+        prompt = message;
+    }
+
+    if (!searchPrompt.empty())
+    {
+        prompt = searchPrompt;
     }
 
     writeToScreen(height - 1, 0, prompt.c_str());
@@ -141,8 +202,23 @@ void Controller::drawScreen() const
 
 void Controller::handleInput()
 {
+    // Wake up now and then to show the results of a running search
+    timeout(searchJob ? searchPollInterval : -1);
+
     int ch = getch();
 
+    if (searchJob)
+    {
+        pollSearch();
+    }
+
+    if (ch == ERR)
+    {
+        return;
+    }
+
+    message.clear();
+
     if (!activeView().viewingOutline)
     {
         handlePageInput(ch);
@@ -157,7 +233,7 @@ void Controller::drawPage() const
 {
     const Page& page = activePage();
 
-    const vector<vector<string>>& grid = page.grid();
+    const pmr::vector<pmr::vector<pmr::string>>& grid = page.grid();
 
     for (i32 screenY = 0; screenY < height - 1; screenY++)
     {
@@ -177,27 +253,30 @@ void Controller::drawPage() const
             continue;
         }
 
-        vector<pair<i32, i32>> highlights;
-        vector<bool> activeHighlight;
+        // Start, end and colour pair of each highlighted region
+        vector<tuple<i32, i32, i32>> highlights;
 
         // Find highlighted regions
         if (search != "")
         {
-            for (const SearchResultLocation& searchResult : searchResults())
+            for (size_t i : searchResults().onRow(activeView().pageIndex, lineIndex))
             {
-                if (searchResult.pageIndex != activeView().pageIndex)
-                {
-                    continue;
-                }
+                SearchResultLocation searchResult = searchResults().at(i);
 
-                if (searchResult.y != lineIndex)
-                {
-                    continue;
-                }
+                i32 colorPair = i == activeView().searchResultIndex ? 2 : highlightPair(searchResult.pattern);
 
-                highlights.push_back({ searchResult.x, searchResult.x + charwiseSize(search) });
-                activeHighlight.push_back(activeSearchResult() == searchResult);
+                highlights.push_back({ searchResult.x, searchResult.x + searchResult.length, colorPair });
             }
+
+            for (const auto& [ owner, continuation ] : searchResults().continuationsOnRow(activeView().pageIndex, lineIndex))
+            {
+                i32 colorPair = owner == activeView().searchResultIndex ? 2 : highlightPair(continuation.pattern);
+
+                highlights.push_back({ continuation.x, continuation.x + continuation.length, colorPair });
+            }
+
+            // Continuations of results from earlier rows or pages are out of order
+            sort(highlights.begin(), highlights.end());
         }
 
         // Draw whole line
@@ -217,17 +296,17 @@ void Controller::drawPage() const
 
             for (size_t i = 0; i < highlights.size(); i++)
             {
-                const auto& [ start, end ] = highlights.at(i);
-                bool active = activeHighlight.at(i);
+                const auto& [ start, end, colorPair ] = highlights.at(i);
 
-                if (end < activeView().panIndex)
+                // Overlaps only happen between a continuation and another result, the first drawn wins
+                if (end < activeView().panIndex || (start < readHead && readHead > activeView().panIndex))
                 {
                     continue;
                 }
                 else if (start < activeView().panIndex)
                 {
                     parts.push_back(charwiseSubstring(line, activeView().panIndex, end - activeView().panIndex));
-                    highlighted.push_back(active ? 2 : 1);
+                    highlighted.push_back(colorPair);
 
                     readHead = end;
                 }
@@ -237,7 +316,7 @@ void Controller::drawPage() const
                     highlighted.push_back(0);
 
                     parts.push_back(charwiseSubstring(line, start, end - start));
-                    highlighted.push_back(active ? 2 : 1);
+                    highlighted.push_back(colorPair);
 
                     readHead = end;
                 }
@@ -253,25 +332,17 @@ void Controller::drawPage() const
                 const string& part = parts.at(i);
                 i32 highlight = highlighted.at(i);
 
-                switch (highlight)
+                if (highlight == 0)
                 {
-                case 0 :
-                    writeToScreen(screenY, x, part.c_str());
-                    break;
-                case 1 :
-                    attron(COLOR_PAIR(1));
-                    attron(A_REVERSE);
                     writeToScreen(screenY, x, part.c_str());
-                    attroff(A_REVERSE);
-                    attroff(COLOR_PAIR(1));
-                    break;
-                case 2 :
-                    attron(COLOR_PAIR(2));
+                }
+                else
+                {
+                    attron(COLOR_PAIR(highlight));
                     attron(A_REVERSE);
                     writeToScreen(screenY, x, part.c_str());
                     attroff(A_REVERSE);
-                    attroff(COLOR_PAIR(2));
-                    break;
+                    attroff(COLOR_PAIR(highlight));
                 }
 
                 x += charwiseSize(part);
@@ -280,7 +351,7 @@ void Controller::drawPage() const
     }
 }
 
-void Controller::drawOutline(i32 x, i32* readY, i32* writeY, const vector<Outline>& outline) const
+void Controller::drawOutline(i32 x, i32* readY, i32* writeY, const pmr::vector<Outline>& outline) const
 {
     i32 panIndex = activeView().outlinePanIndex;
     i32 scrollIndex = activeView().outlineScrollIndex;
@@ -296,7 +367,7 @@ void Controller::drawOutline(i32 x, i32* readY, i32* writeY, const vector<Outlin
         vector<i32> highlighted;
         highlighted.reserve(3);
 
-        parts.push_back(string(x, ' ') + item.title() + " (");
+        parts.push_back(string(x, ' ') + string(item.title()) + " (");
         highlighted.push_back(selected ? 2 : 0);
         parts.push_back(to_string(item.page() + 1));
         highlighted.push_back(1);
@@ -457,6 +528,29 @@ void Controller::handlePageInput(int ch)
     case ':' :
         goToPage();
         break;
+    // i, I
+    case 'i' :
+    case 'I' :
+        showIndexInfo();
+        break;
+    // c, C
+    case 'c' :
+    case 'C' :
+        cycleCaseMode();
+        break;
+    // 0 through 9
+    case '0' :
+    case '1' :
+    case '2' :
+    case '3' :
+    case '4' :
+    case '5' :
+    case '6' :
+    case '7' :
+    case '8' :
+    case '9' :
+        focusPattern(ch - '1');
+        break;
     }
 }
 
@@ -721,26 +815,25 @@ void Controller::nextSearchResult()
         return;
     }
 
-    if (activeView().searchResultIndex + 1 == activeView().searchResults.size())
-    {
-        activeView().searchResultIndex = 0;
-    }
-    else
+    // Skips results of other patterns while one is focused, going all the way round if none are left
+    for (size_t i = 0; i < activeView().searchResults.size(); i++)
     {
-        activeView().searchResultIndex++;
-    }
-
-    activeView().pageIndex = activeSearchResult().pageIndex;
+        if (activeView().searchResultIndex + 1 == activeView().searchResults.size())
+        {
+            activeView().searchResultIndex = 0;
+        }
+        else
+        {
+            activeView().searchResultIndex++;
+        }
 
-    if (activeSearchResult().y < activeView().scrollIndex || activeSearchResult().y >= activeView().scrollIndex + (height - 1))
-    {
-        activeView().scrollIndex = max((activeSearchResult().y + 1) - (height - 1), 0);
+        if (focusedPattern < 0 || activeSearchResult().pattern == focusedPattern)
+        {
+            break;
+        }
     }
 
-    if (activeSearchResult().x < activeView().panIndex || activeSearchResult().x + charwiseSize(search) >= activeView().panIndex + width)
-    {
-        activeView().panIndex = max<i32>((activeSearchResult().x + charwiseSize(search)) - width, 0);
-    }
+    showSearchResult();
 }
 
 void Controller::previousSearchResult()
@@ -750,15 +843,29 @@ void Controller::previousSearchResult()
         return;
     }
 
-    if (activeView().searchResultIndex == 0)
+    // Skips results of other patterns while one is focused, going all the way round if none are left
+    for (size_t i = 0; i < activeView().searchResults.size(); i++)
     {
-        activeView().searchResultIndex = activeView().searchResults.size() - 1;
-    }
-    else
-    {
-        activeView().searchResultIndex--;
+        if (activeView().searchResultIndex == 0)
+        {
+            activeView().searchResultIndex = activeView().searchResults.size() - 1;
+        }
+        else
+        {
+            activeView().searchResultIndex--;
+        }
+
+        if (focusedPattern < 0 || activeSearchResult().pattern == focusedPattern)
+        {
+            break;
+        }
     }
 
+    showSearchResult();
+}
+
+void Controller::showSearchResult()
+{
     activeView().pageIndex = activeSearchResult().pageIndex;
 
     if (activeSearchResult().y < activeView().scrollIndex || activeSearchResult().y >= activeView().scrollIndex + (height - 1))
@@ -766,85 +873,516 @@ void Controller::previousSearchResult()
         activeView().scrollIndex = max((activeSearchResult().y + 1) - (height - 1), 0);
     }
 
-    if (activeSearchResult().x < activeView().panIndex || activeSearchResult().x + charwiseSize(search) >= activeView().panIndex + width)
+    if (activeSearchResult().x < activeView().panIndex || activeSearchResult().x + activeSearchResult().length >= activeView().panIndex + width)
     {
-        activeView().panIndex = max<i32>((activeSearchResult().x + charwiseSize(search)) - width, 0);
+        activeView().panIndex = max<i32>((activeSearchResult().x + activeSearchResult().length) - width, 0);
     }
 }
 
 void Controller::startForwardSearch()
 {
-    string buffer(maxSearchLength, '\0');
+    searchForwards = true;
 
-    move(height - 1, 0);
-    clrtoeol();
-    writeToScreen(height - 1, 0, "/");
-    echo();
-    mvgetnstr(height - 1, 1, buffer.data(), maxSearchLength);
-    noecho();
+    readSearch("/");
+}
 
-    search = buffer.data();
-    searchForwards = true;
+void Controller::startBackwardSearch()
+{
+    searchForwards = false;
+
+    readSearch("?");
+}
+
+void Controller::readSearch(const string& prefix)
+{
+    string previousSearch = search;
+    map<string, DocumentView> previousViews = views;
+
+    string buffer;
+    vector<SearchStep> steps;
+    // The history entry in the prompt, or one past the newest while typing a new search
+    size_t historyIndex = searchHistory.size();
+    // What was typed before going back through the history
+    string typed;
+
+    cancelSearch();
+
+    setSearch("");
+    focusedPattern = -1;
 
     for (auto& [ name, view ] : views)
     {
-        view.searchResults = documents.at(name).search(search);
+        setSearchResults(name, SearchResults());
+    }
+
+    curs_set(1);
+
+    while (true)
+    {
+        // Searches served from the cache finish before the screen is drawn
+        if (searchJob)
+        {
+            optional<SearchStep> step = pollSearch();
+
+            // Only finished searches are kept, a longer search can't refine one that stopped partway
+            if (step)
+            {
+                steps.push_back(move(*step));
+            }
+        }
+
+        searchPrompt = prefix + buffer;
+
+        drawScreen();
+
+        // Wake up now and then to show the results of a running search
+        timeout(searchJob ? searchPollInterval : -1);
+
+        int ch = getch();
+
+        if (ch == ERR)
+        {
+            continue;
+        }
+        // enter
+        else if (ch == '\n' || ch == KEY_ENTER)
+        {
+            if (!buffer.empty())
+            {
+                erase(searchHistory, buffer);
+                searchHistory.push_back(buffer);
+
+                if (searchHistory.size() > searchHistorySize)
+                {
+                    searchHistory.erase(searchHistory.begin());
+                }
+            }
 
-        for (SearchResultLocation& searchResult : view.searchResults)
+            // A search still running is cached once it finishes, one that already has is cached now
+            if (searchJob)
+            {
+                searchJob->committed = true;
+            }
+            else if (!buffer.empty())
+            {
+                for (const auto& [ name, view ] : views)
+                {
+                    searchCache.insert(name, search, caseMode, view.searchResults);
+                }
+            }
+
+            break;
+        }
+        // escape, or backspace on an empty prompt
+        else if (ch == 27 || ((ch == KEY_BACKSPACE || ch == 127 || ch == '\b') && buffer.empty()))
         {
-            searchResult.documentName = name;
+            cancelSearch();
+
+            setSearch(previousSearch);
+            views = previousViews;
+            break;
         }
+        // up, down
+        else if (ch == KEY_UP || ch == KEY_DOWN)
+        {
+            if (ch == KEY_UP && historyIndex > 0)
+            {
+                if (historyIndex == searchHistory.size())
+                {
+                    typed = buffer;
+                }
+
+                historyIndex--;
+            }
+            else if (ch == KEY_DOWN && historyIndex < searchHistory.size())
+            {
+                historyIndex++;
+            }
+            else
+            {
+                continue;
+            }
+
+            buffer = historyIndex < searchHistory.size() ? searchHistory.at(historyIndex) : typed;
+
+            cancelSearch();
+
+            // The steps are prefixes of what was in the prompt, a recalled search is usually in the cache instead
+            steps.clear();
+
+            setSearch(buffer);
+
+            if (buffer.empty())
+            {
+                for (auto& [ name, view ] : views)
+                {
+                    setSearchResults(name, SearchResults());
+                }
+            }
+            else
+            {
+                startSearch(nullptr, previousViews, false);
+            }
+        }
+        // backspace
+        else if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b')
+        {
+            buffer.erase(lastCharacterOffset(buffer));
 
-        view.searchResultIndex = 0;
+            cancelSearch();
 
-        for (size_t i = 0; i < view.searchResults.size(); i++)
+            // Every cached step is a prefix of the buffer, drop the ones it no longer reaches
+            while (!steps.empty() && steps.back().search.size() > buffer.size())
+            {
+                steps.pop_back();
+            }
+
+            setSearch(buffer);
+
+            if (buffer.empty() || (!steps.empty() && steps.back().search == buffer))
+            {
+                for (auto& [ name, view ] : views)
+                {
+                    setSearchResults(name, !steps.empty() ? steps.back().results.at(name) : SearchResults());
+                }
+            }
+            // The search for this prefix was cancelled before it finished
+            else
+            {
+                startSearch(!steps.empty() ? &steps.back() : nullptr, previousViews, false);
+            }
+        }
+        else if (ch >= ' ' && ch <= 0xff && ch != 127 && buffer.size() < maxSearchLength)
         {
-            const SearchResultLocation& searchResult = view.searchResults.at(i);
+            buffer += static_cast<char>(ch);
 
-            if (searchResult.pageIndex >= view.pageIndex)
+            // Wait for the rest of a multi-byte character
+            if (endsMidCharacter(buffer))
             {
-                view.searchResultIndex = i;
-                break;
+                continue;
             }
+
+            setSearch(buffer);
+
+            startSearch(!steps.empty() ? &steps.back() : nullptr, previousViews, false);
         }
     }
+
+    searchPrompt = "";
+
+    curs_set(0);
 }
 
-void Controller::startBackwardSearch()
+void Controller::setSearch(const string& search)
 {
-    string buffer(maxSearchLength, '\0');
+    this->search = search;
+    searchQuery = parseSearch(search);
+    searchError = ::searchError(searchQuery);
+}
 
-    move(height - 1, 0);
-    clrtoeol();
-    writeToScreen(height - 1, 0, "?");
-    echo();
-    mvgetnstr(height - 1, 1, buffer.data(), maxSearchLength);
-    noecho();
+void Controller::startSearch(const SearchStep* previous, const map<string, DocumentView>& origins, bool committed)
+{
+    cancelSearch();
 
-    search = buffer.data();
-    searchForwards = false;
+    shared_ptr<SearchJob> job = make_shared<SearchJob>();
+    job->search = search;
+    job->caseMode = caseMode;
+    job->committed = committed;
+    job->cancelled = false;
+    job->hits = make_shared<map<string, vector<vector<size_t>>>>();
+    job->pending = 0;
 
-    for (auto& [ name, view ] : views)
+    if (previous && refines(previous->search, search))
     {
-        view.searchResults = documents.at(name).search(search);
+        job->previousHits = previous->hits;
+    }
+
+    vector<string> names;
+    names.reserve(views.size());
 
-        for (SearchResultLocation& searchResult : view.searchResults)
+    // The active document goes first so its hits are on screen before the rest are done
+    if (views.contains(activeDocumentName))
+    {
+        names.push_back(activeDocumentName);
+    }
+
+    for (const auto& [ name, view ] : views)
+    {
+        if (name != activeDocumentName)
         {
-            searchResult.documentName = name;
+            names.push_back(name);
         }
+    }
 
-        view.searchResultIndex = view.searchResults.size() - 1;
+    vector<vector<SearchTask>> tasks;
+    tasks.reserve(names.size());
 
-        for (size_t i = view.searchResults.size() - 1; i < view.searchResults.size(); i--)
+    // Every task is built before any is submitted, nothing else may touch the job once they run
+    for (const string& name : names)
+    {
+        DocumentSearch& documentSearch = job->documents[name];
+        documentSearch.publishedPages = 0;
+        documentSearch.originPage = origins.contains(name) ? origins.at(name).pageIndex : views.at(name).pageIndex;
+        documentSearch.seeded = false;
+
+        const SearchResults* cached = searchCache.find(name, search, caseMode);
+
+        // Cached results are in place from the start, leaving no pages to search or publish
+        if (cached)
         {
-            const SearchResultLocation& searchResult = view.searchResults.at(i);
+            documentSearch.finished.assign(documents.at(name).pages().size(), true);
+            documentSearch.publishedPages = documentSearch.finished.size();
+
+            tasks.push_back({});
+
+            setSearchResults(name, *cached);
+            continue;
+        }
+
+        tasks.push_back(documents.at(name).searchTasks(
+            search,
+            caseMode,
+            job->previousHits && job->previousHits->contains(name) ? &job->previousHits->at(name) : nullptr,
+            &(*job->hits)[name],
+            &documentSearch.pageResults
+        ));
+
+        // Pages without a task have nothing to wait for
+        documentSearch.finished.assign(documentSearch.pageResults.size(), true);
 
-            if (searchResult.pageIndex == view.pageIndex)
+        for (const SearchTask& task : tasks.back())
+        {
+            documentSearch.finished.at(task.pageIndex) = false;
+        }
+
+        job->pending += tasks.back().size();
+
+        setSearchResults(name, SearchResults());
+    }
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        DocumentSearch* documentSearch = &job->documents.at(names.at(i));
+
+        for (SearchTask& task : tasks.at(i))
+        {
+            searchPool.submit([job, documentSearch, task = move(task)]() -> void {
+                if (!job->cancelled)
+                {
+                    task.run();
+                }
+
+                lock_guard<mutex> guard(job->lock);
+
+                documentSearch->finished.at(task.pageIndex) = true;
+                job->pending--;
+            });
+        }
+    }
+
+    searchJob = job;
+}
+
+optional<Controller::SearchStep> Controller::pollSearch()
+{
+    shared_ptr<SearchJob> job = searchJob;
+
+    map<string, size_t> finishedPages;
+    bool finished;
+
+    {
+        lock_guard<mutex> guard(job->lock);
+
+        // Results are published a page at a time in page order, so only up to the first page still running
+        for (const auto& [ name, documentSearch ] : job->documents)
+        {
+            size_t pages = documentSearch.publishedPages;
+
+            while (pages < documentSearch.finished.size() && documentSearch.finished.at(pages))
+            {
+                pages++;
+            }
+
+            finishedPages.insert({ name, pages });
+        }
+
+        finished = job->pending == 0;
+    }
+
+    for (auto& [ name, documentSearch ] : job->documents)
+    {
+        DocumentView& view = views.at(name);
+
+        for (; documentSearch.publishedPages < finishedPages.at(name); documentSearch.publishedPages++)
+        {
+            vector<SearchResultLocation>& results = documentSearch.pageResults.at(documentSearch.publishedPages);
+
+            for (const SearchResultLocation& result : results)
             {
-                view.searchResultIndex = i;
-                break;
+                view.searchResults.add(result);
             }
+
+            vector<SearchResultLocation>().swap(results);
+        }
+
+        if (documentSearch.seeded)
+        {
+            continue;
         }
+
+        bool documentFinished = documentSearch.publishedPages == documentSearch.finished.size();
+
+        auto [ first, last ] = view.searchResults.pageRange(documentSearch.originPage);
+
+        // Forwards starts at the first result from the origin page on, backwards at the last one up to it
+        if (searchForwards && first < view.searchResults.size())
+        {
+            view.searchResultIndex = first;
+            documentSearch.seeded = true;
+        }
+        else if (!searchForwards && documentSearch.publishedPages > static_cast<size_t>(documentSearch.originPage) && last > 0)
+        {
+            view.searchResultIndex = last - 1;
+            documentSearch.seeded = true;
+        }
+        // Wrap around once it is clear there is nothing in the preferred direction
+        else if (documentFinished)
+        {
+            view.searchResultIndex = searchForwards ? 0 : view.searchResults.size() - 1;
+            documentSearch.seeded = true;
+        }
+
+        if (documentSearch.seeded && name == activeDocumentName && !view.searchResults.empty())
+        {
+            showSearchResult();
+        }
+    }
+
+    if (!finished)
+    {
+        return {};
+    }
+
+    SearchStep step;
+    step.search = job->search;
+    step.hits = job->hits;
+
+    for (const auto& [ name, documentSearch ] : job->documents)
+    {
+        step.results.insert({ name, views.at(name).searchResults });
+    }
+
+    if (job->committed)
+    {
+        for (const auto& [ name, results ] : step.results)
+        {
+            searchCache.insert(name, job->search, job->caseMode, results);
+        }
+    }
+
+    searchJob = nullptr;
+
+    return step;
+}
+
+void Controller::cancelSearch()
+{
+    if (!searchJob)
+    {
+        return;
+    }
+
+    searchJob->cancelled = true;
+    searchJob = nullptr;
+}
+
+void Controller::setSearchResults(const string& name, const SearchResults& results)
+{
+    DocumentView& view = views.at(name);
+
+    view.searchResults = results;
+
+    auto [ first, last ] = view.searchResults.pageRange(view.pageIndex);
+
+    // Forwards starts at the first result from this page on, backwards at the last one on this page
+    if (searchForwards)
+    {
+        view.searchResultIndex = first < view.searchResults.size() ? first : 0;
+    }
+    else
+    {
+        view.searchResultIndex = first < last ? last - 1 : view.searchResults.size() - 1;
+    }
+}
+
+void Controller::showIndexInfo()
+{
+    const Document& document = activeDocument();
+
+    if (!document.indexed())
+    {
+        message = format(
+            "Search index is still building, trigram index {} KiB, search text {} KiB",
+            document.trigramIndexSize() / 1024,
+            document.searchTextSize() / 1024
+        );
+        return;
+    }
+
+    message = format(
+        "Search index {} KiB, {} in {} ms, trigram index {} KiB, search text {} KiB",
+        document.indexSize() / 1024,
+        document.indexCached() ? "loaded from cache" : "built",
+        document.indexBuildTime().count(),
+        document.trigramIndexSize() / 1024,
+        document.searchTextSize() / 1024
+    );
+}
+
+void Controller::cycleCaseMode()
+{
+    switch (caseMode)
+    {
+    case CaseMode::Sensitive :
+        caseMode = CaseMode::Smart;
+        message = "Smart case search";
+        break;
+    case CaseMode::Smart :
+        caseMode = CaseMode::Ignore;
+        message = "Case-insensitive search";
+        break;
+    case CaseMode::Ignore :
+        caseMode = CaseMode::Sensitive;
+        message = "Case-sensitive search";
+        break;
+    }
+
+    if (!search.empty())
+    {
+        startSearch(nullptr, views, true);
+    }
+}
+
+void Controller::focusPattern(i32 pattern)
+{
+    if (searchQuery.kind != SearchKind::Multiple || pattern >= static_cast<i32>(searchQuery.patterns.size()))
+    {
+        return;
+    }
+
+    focusedPattern = pattern;
+
+    if (focusedPattern < 0)
+    {
+        message = "Cycling through all patterns";
+        return;
+    }
+
+    message = format("Cycling through {}", searchQuery.patterns.at(focusedPattern));
+
+    if (!searchResults().empty() && activeSearchResult().pattern != focusedPattern)
+    {
+        searchForwards ? nextSearchResult() : previousSearchResult();
     }
 }
 
@@ -918,7 +1456,7 @@ void Controller::panRightOutline()
 
 SearchResultLocation Controller::seedSearchResult() const
 {
-    return SearchResultLocation(activeDocumentName, activeView().pageIndex);
+    return SearchResultLocation(activeView().pageIndex);
 }
 
 i32 Controller::pages() const
@@ -999,7 +1537,7 @@ const DocumentView& Controller::activeView() const
         : emptyView;
 }
 
-const vector<SearchResultLocation>& Controller::searchResults() const
+const SearchResults& Controller::searchResults() const
 {
     return activeView().searchResults;
 }
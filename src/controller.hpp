@@ -21,6 +21,9 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "types.hpp"
 #include "document.hpp"
 #include "document_view.hpp"
+#include "thread_pool.hpp"
+#include "search_cache.hpp"
+#include "search_query.hpp"
 
 class Controller
 {
@@ -43,6 +46,45 @@ public:
     bool shouldQuit() const;
 
 private:
+    // The state of one query typed at the search prompt, kept so backspace can return to it
+    struct SearchStep
+    {
+        string search;
+        // Match offsets of each document's pages, overlapping matches included, shared with the searches refining them,
+        // documents whose results came from the cache have none
+        shared_ptr<map<string, vector<vector<size_t>>>> hits;
+        map<string, SearchResults> results;
+    };
+
+    // One document's part of a running search
+    struct DocumentSearch
+    {
+        vector<vector<SearchResultLocation>> pageResults;
+        // Set as each page's task finishes, guarded by the search's lock
+        vector<bool> finished;
+        // Pages before this one have been added to the view's results, which must stay in page order
+        size_t publishedPages;
+        // The page the view was on when the search started, where its first result is looked for
+        i32 originPage;
+        bool seeded;
+    };
+
+    // A search running on the pool, its tasks skip their pages once it is cancelled
+    struct SearchJob
+    {
+        string search;
+        CaseMode caseMode;
+        // Only searches that were entered are cached, not the prefixes typed on the way to them
+        bool committed;
+        atomic<bool> cancelled;
+        shared_ptr<const map<string, vector<vector<size_t>>>> previousHits;
+        shared_ptr<map<string, vector<vector<size_t>>>> hits;
+        map<string, DocumentSearch> documents;
+        mutex lock;
+        // Tasks still queued or running, guarded by lock
+        size_t pending;
+    };
+
     bool displayOpen;
 
     i32 width;
@@ -58,14 +100,30 @@ private:
 
     bool quit;
     string search;
+    // Parsed once each time search changes instead of on every redraw
+    SearchQuery searchQuery;
+    // Why searchQuery can't be run, or empty if it can
+    string searchError;
     bool searchForwards;
+    CaseMode caseMode;
+    // The pattern of a multiple pattern search n and N stay on, or -1 for all of them
+    i32 focusedPattern;
+    // Shown in place of the status line until the next key press
+    string message;
+    // Shown in place of the status line while a search is being typed
+    string searchPrompt;
+    ThreadPool searchPool;
+    shared_ptr<SearchJob> searchJob;
+    SearchCache searchCache;
+    // Searches entered at the prompt, oldest first
+    vector<string> searchHistory;
 
     void updateSize();
     void drawScreen() const;
     void handleInput();
 
     void drawPage() const;
-    void drawOutline(i32 x, i32* readY, i32* writeY, const vector<Outline>& outline) const;
+    void drawOutline(i32 x, i32* readY, i32* writeY, const pmr::vector<Outline>& outline) const;
     void handlePageInput(int ch);
     void handleOutlineInput(int ch);
 
@@ -89,6 +147,16 @@ private:
     void previousSearchResult();
     void startForwardSearch();
     void startBackwardSearch();
+    void readSearch(const string& prefix);
+    void setSearch(const string& search);
+    void startSearch(const SearchStep* previous, const map<string, DocumentView>& origins, bool committed);
+    optional<SearchStep> pollSearch();
+    void cancelSearch();
+    void showSearchResult();
+    void setSearchResults(const string& name, const SearchResults& results);
+    void showIndexInfo();
+    void cycleCaseMode();
+    void focusPattern(i32 pattern);
 
     void goToStartOfOutline();
     void goToEndOfOutline();
@@ -117,6 +185,6 @@ private:
     const Document& activeDocument() const;
     DocumentView& activeView();
     const DocumentView& activeView() const;
-    const vector<SearchResultLocation>& searchResults() const;
+    const SearchResults& searchResults() const;
     SearchResultLocation activeSearchResult() const;
 };
@@ -18,20 +18,75 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 */
 #include "document.hpp"
 #include "constants.hpp"
+#include "charwise.hpp"
+#include "substring_search.hpp"
+#include "search_query.hpp"
+#include "regex.hpp"
+#include "fuzzy_pattern.hpp"
+#include "aho_corasick.hpp"
+#include "phrase_pattern.hpp"
+#include "index_cache.hpp"
+
+// Lines end in line breaks and blocks, and so pages, in null bytes
+static constexpr string_view lineBreaks("\n\0", 2);
+
+static vector<TextSpan> hitSpans(const vector<size_t>& hits, size_t size)
+{
+    vector<TextSpan> spans;
+    spans.reserve(hits.size());
+
+    for (size_t hit : hits)
+    {
+        spans.push_back({ hit, size });
+    }
+
+    return spans;
+}
 
 Document::Document()
+    : arena(make_unique<pmr::monotonic_buffer_resource>(documentArenaInitialSize))
+    , _pages(arena.get())
+    , _outline(arena.get())
+    , searchText(make_shared<SearchText>())
+    , index(make_shared<SearchIndex>())
+    , gridGenerated(false)
 {
 
 }
 
-void Document::add(const Page& page)
+pmr::polymorphic_allocator<> Document::allocator() const
 {
-    _pages.push_back(page);
+    return arena.get();
 }
 
-void Document::setOutline(const vector<Outline>& outline)
+void Document::reserve(size_t count)
 {
-    _outline = outline;
+    _pages.reserve(count);
+}
+
+void Document::add(Page&& page)
+{
+    pageBlockOffsets.push_back(blockTextOffsets.size());
+    pageSearchOffsets.push_back(searchText->text().size());
+
+    for (const Block& block : page.blocks())
+    {
+        blockTextOffsets.push_back(_text.size());
+        _text += block.text();
+        _text += '\0';
+
+        searchText->append(block.text());
+        searchText->append(string_view("\0", 1));
+    }
+
+    trigrams.addPage(_pages.size(), string_view(searchText->text()).substr(pageSearchOffsets.back()));
+
+    _pages.push_back(move(page));
+}
+
+void Document::setOutline(pmr::vector<Outline>&& outline)
+{
+    _outline = move(outline);
 }
 
 void Document::generateGrid()
@@ -67,44 +122,559 @@ void Document::generateGrid()
     {
         worker.join();
     }
+
+    gridGenerated = true;
 }
 
-vector<SearchResultLocation> Document::search(const string& search) const
+void Document::startIndexing(const filesystem::path& source)
 {
-    vector<SearchResultLocation> results;
+    thread([searchText = searchText, index = index, source]() -> void {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        filesystem::path cachePath = indexCachePath(source);
+
+        shared_ptr<const SuffixArray> suffixArray;
+
+        if (!cachePath.empty())
+        {
+            suffixArray = SuffixArray::load(cachePath, searchText->text());
+        }
+
+        bool cached = suffixArray != nullptr;
+
+        if (cached)
+        {
+            touchIndexCache(cachePath);
+        }
+        else
+        {
+            suffixArray = make_shared<const SuffixArray>(searchText->text());
+        }
+
+        {
+            lock_guard<mutex> lock(index->lock);
+
+            index->suffixArray = suffixArray;
+            index->buildTime = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+            index->cached = cached;
+        }
+
+        // Missing, stale and corrupt files are all replaced, making room for the new one
+        if (!cached && !cachePath.empty())
+        {
+            suffixArray->save(cachePath, searchText->text());
+            pruneIndexCache();
+        }
+    }).detach();
+}
+
+void Document::loadIndex(const filesystem::path& source)
+{
+    filesystem::path cachePath = indexCachePath(source);
+
+    if (cachePath.empty())
+    {
+        return;
+    }
+
+    shared_ptr<const SuffixArray> suffixArray = SuffixArray::load(cachePath, searchText->text());
+
+    if (suffixArray)
+    {
+        touchIndexCache(cachePath);
+    }
+
+    lock_guard<mutex> lock(index->lock);
+
+    index->suffixArray = suffixArray;
+    index->cached = suffixArray != nullptr;
+}
+
+SearchResults Document::search(const string& search, CaseMode caseMode) const
+{
+    vector<vector<size_t>> pageHits;
+    vector<vector<SearchResultLocation>> pageResults;
+
+    for (SearchTask& task : searchTasks(search, caseMode, nullptr, &pageHits, &pageResults))
+    {
+        task.run();
+    }
+
+    return mergeSearchResults(move(pageResults));
+}
+
+vector<SearchTask> Document::searchTasks(
+    const string& search,
+    CaseMode caseMode,
+    const vector<vector<size_t>>* previousHits,
+    vector<vector<size_t>>* pageHits,
+    vector<vector<SearchResultLocation>>* pageResults
+) const
+{
+    vector<SearchTask> tasks;
+
+    pageHits->assign(_pages.size(), vector<size_t>());
+    pageResults->assign(_pages.size(), vector<SearchResultLocation>());
 
     if (search.empty())
     {
-        return results;
+        return tasks;
+    }
+
+    SearchQuery query = parseSearch(search);
+
+    if (query.kind == SearchKind::Regex)
+    {
+        return regexSearchTasks(query.pattern, caseMode, pageResults);
+    }
+    else if (query.kind == SearchKind::Fuzzy)
+    {
+        return fuzzySearchTasks(query.pattern, query.distance, caseMode, pageResults);
+    }
+    else if (query.kind == SearchKind::Multiple)
+    {
+        // Pattern numbers wouldn't fit in the results
+        if (query.patterns.size() > maxSearchPatterns)
+        {
+            return tasks;
+        }
+
+        return multipleSearchTasks(query.patterns, caseMode, pageResults);
+    }
+    else if (query.kind == SearchKind::Phrase)
+    {
+        return phraseSearchTasks(query.pattern, caseMode, pageResults);
+    }
+
+    string folded = normalizeForSearch(query.pattern, true);
+
+    if (folded.empty())
+    {
+        return tasks;
+    }
+
+    // Smart case only ignores case while the search is all lower case
+    bool caseSensitive = caseMode == CaseMode::Sensitive || (caseMode == CaseMode::Smart && hasUpperCase(query.pattern));
+    // Case-sensitive matches are compared after normalization so ligatures and the like still match
+    string normalized = caseSensitive ? normalizeForSearch(query.pattern, false) : "";
+
+    auto accept = [normalized, caseSensitive](const TextSpan&, i32, string_view match) -> bool {
+        return !caseSensitive || normalizeForSearch(match, false) == normalized;
+    };
+
+    if (previousHits)
+    {
+        for (i32 pageIndex = 0; pageIndex < static_cast<i32>(previousHits->size()); pageIndex++)
+        {
+            if (previousHits->at(pageIndex).empty())
+            {
+                continue;
+            }
+
+            tasks.push_back({ pageIndex, [this, folded, accept, pageIndex, previousHits, pageHits, pageResults]() -> void {
+                vector<size_t>& hits = pageHits->at(pageIndex);
+
+                for (size_t offset : previousHits->at(pageIndex))
+                {
+                    if (string_view(searchText->text()).substr(offset, folded.size()) == folded)
+                    {
+                        hits.push_back(offset);
+                    }
+                }
+
+                pageResults->at(pageIndex) = placeHits(pageIndex, hitSpans(hits, folded.size()), {}, accept);
+            } });
+        }
+
+        return tasks;
     }
 
-    for (size_t i = 0; i < _pages.size(); i++)
+    shared_ptr<const SuffixArray> suffixArray;
+
+    {
+        lock_guard<mutex> lock(index->lock);
+
+        suffixArray = index->suffixArray;
+    }
+
+    if (suffixArray)
     {
-        const Page& page = _pages.at(i);
+        vector<size_t> hits = suffixArray->find(searchText->text(), folded);
 
-        vector<SearchResultLocation> pageResults = page.search(search);
+        auto start = hits.begin();
 
-        for (SearchResultLocation& pageResult : pageResults)
+        while (start != hits.end())
         {
-            pageResult.pageIndex = i;
+            i32 pageIndex = pageAt(blockAt(searchText->originalStart(*start)));
+
+            auto end = lower_bound(start, hits.end(), pageSearchOffset(pageIndex + 1));
+
+            pageHits->at(pageIndex).assign(start, end);
+
+            tasks.push_back({ pageIndex, [this, folded, accept, pageIndex, pageHits, pageResults]() -> void {
+                pageResults->at(pageIndex) = placeHits(pageIndex, hitSpans(pageHits->at(pageIndex), folded.size()), {}, accept);
+            } });
+
+            start = end;
         }
+    }
+    else
+    {
+        optional<vector<i32>> candidates = trigrams.candidatePages(folded);
+
+        if (!candidates)
+        {
+            candidates = vector<i32>(_pages.size());
+            iota(candidates->begin(), candidates->end(), 0);
+        }
+
+        for (i32 pageIndex : *candidates)
+        {
+            tasks.push_back({ pageIndex, [this, folded, accept, pageIndex, pageHits, pageResults]() -> void {
+                pageHits->at(pageIndex) = scanPage(pageIndex, folded);
+                pageResults->at(pageIndex) = placeHits(pageIndex, hitSpans(pageHits->at(pageIndex), folded.size()), {}, accept);
+            } });
+        }
+    }
+
+    return tasks;
+}
 
-        results.insert(results.end(), pageResults.begin(), pageResults.end());
+vector<SearchTask> Document::regexSearchTasks(
+    const string& pattern,
+    CaseMode caseMode,
+    vector<vector<SearchResultLocation>>* pageResults
+) const
+{
+    vector<SearchTask> tasks;
+
+    // Matched against the case-folded search text, which neither index helps with
+    shared_ptr<const Regex> regex = make_shared<const Regex>(pattern, true);
+
+    if (!regex->valid())
+    {
+        return tasks;
+    }
+
+    bool caseSensitive = caseMode == CaseMode::Sensitive || (caseMode == CaseMode::Smart && regex->hasUpperCase());
+    // Case-sensitive matches must also match the unfolded expression on their own
+    shared_ptr<const Regex> exact = caseSensitive ? make_shared<const Regex>(pattern, false) : nullptr;
+
+    auto accept = [this, exact](const TextSpan& hit, i32, string_view match) -> bool {
+        if (!exact)
+        {
+            return true;
+        }
+
+        const string& text = searchText->text();
+
+        char before = hit.offset > 0 ? text.at(hit.offset - 1) : '\0';
+        char after = hit.offset + hit.size < text.size() ? text.at(hit.offset + hit.size) : '\0';
+
+        return exact->matches(normalizeForSearch(match, false), before, after);
+    };
+
+    for (i32 pageIndex = 0; pageIndex < static_cast<i32>(_pages.size()); pageIndex++)
+    {
+        tasks.push_back({ pageIndex, [this, regex, accept, pageIndex, pageResults]() -> void {
+            vector<TextSpan> hits = regex->find(searchText->text(), pageSearchOffset(pageIndex), pageSearchOffset(pageIndex + 1));
+
+            pageResults->at(pageIndex) = placeHits(pageIndex, hits, {}, accept);
+        } });
+    }
+
+    return tasks;
+}
+
+vector<SearchTask> Document::fuzzySearchTasks(
+    const string& pattern,
+    i32 distance,
+    CaseMode caseMode,
+    vector<vector<SearchResultLocation>>* pageResults
+) const
+{
+    vector<SearchTask> tasks;
+
+    string folded = normalizeForSearch(pattern, true);
+
+    if (folded.empty())
+    {
+        return tasks;
+    }
+
+    shared_ptr<const FuzzyPattern> fuzzy = make_shared<const FuzzyPattern>(folded, distance);
+
+    bool caseSensitive = caseMode == CaseMode::Sensitive || (caseMode == CaseMode::Smart && hasUpperCase(pattern));
+    // Case-sensitive matches must also be within distance of the unfolded pattern
+    shared_ptr<const FuzzyPattern> exact;
+
+    if (caseSensitive)
+    {
+        exact = make_shared<const FuzzyPattern>(normalizeForSearch(pattern, false), fuzzy->distance());
+    }
+
+    auto accept = [exact](const TextSpan&, i32, string_view match) -> bool {
+        return !exact || exact->distanceTo(normalizeForSearch(match, false)) <= exact->distance();
+    };
+
+    /*
+     * Split into one more piece than there are edits allowed, at least one piece must match exactly, so
+     * only pages with every trigram of some piece can match.
+     */
+    vector<i32> candidates;
+    size_t pieces = fuzzy->distance() + 1;
+
+    for (size_t i = 0; i < pieces; i++)
+    {
+        size_t start = folded.size() * i / pieces;
+        size_t end = folded.size() * (i + 1) / pieces;
+
+        optional<vector<i32>> pages = trigrams.candidatePages(string_view(folded).substr(start, end - start));
+
+        if (!pages)
+        {
+            candidates.resize(_pages.size());
+            iota(candidates.begin(), candidates.end(), 0);
+            break;
+        }
+
+        candidates.insert(candidates.end(), pages->begin(), pages->end());
+    }
+
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (i32 pageIndex : candidates)
+    {
+        tasks.push_back({ pageIndex, [this, fuzzy, accept, pageIndex, pageResults]() -> void {
+            vector<TextSpan> hits = fuzzy->find(searchText->text(), pageSearchOffset(pageIndex), pageSearchOffset(pageIndex + 1));
+
+            pageResults->at(pageIndex) = placeHits(pageIndex, hits, {}, accept);
+        } });
+    }
+
+    return tasks;
+}
+
+vector<SearchTask> Document::multipleSearchTasks(
+    const vector<string>& patterns,
+    CaseMode caseMode,
+    vector<vector<SearchResultLocation>>* pageResults
+) const
+{
+    vector<SearchTask> tasks;
+
+    vector<string> folded;
+    // Smart case applies to each pattern on its own, empty for those matched regardless of case
+    vector<string> normalized;
+
+    for (const string& pattern : patterns)
+    {
+        bool caseSensitive = caseMode == CaseMode::Sensitive || (caseMode == CaseMode::Smart && hasUpperCase(pattern));
+
+        folded.push_back(normalizeForSearch(pattern, true));
+        normalized.push_back(caseSensitive ? normalizeForSearch(pattern, false) : "");
+    }
+
+    shared_ptr<const AhoCorasick> automaton = make_shared<const AhoCorasick>(folded);
+
+    auto accept = [normalized](const TextSpan&, i32 pattern, string_view match) -> bool {
+        return normalized.at(pattern).empty() || normalizeForSearch(match, false) == normalized.at(pattern);
+    };
+
+    // Only pages that could hold at least one of the patterns are scanned
+    vector<i32> candidates;
+
+    for (const string& pattern : folded)
+    {
+        optional<vector<i32>> pages = trigrams.candidatePages(pattern);
+
+        if (!pages)
+        {
+            candidates.resize(_pages.size());
+            iota(candidates.begin(), candidates.end(), 0);
+            break;
+        }
+
+        candidates.insert(candidates.end(), pages->begin(), pages->end());
+    }
+
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (i32 pageIndex : candidates)
+    {
+        tasks.push_back({ pageIndex, [this, automaton, accept, pageIndex, pageResults]() -> void {
+            vector<i32> hitPatterns;
+            vector<TextSpan> hits = automaton->find(searchText->text(), pageSearchOffset(pageIndex), pageSearchOffset(pageIndex + 1), &hitPatterns);
+
+            pageResults->at(pageIndex) = placeHits(pageIndex, hits, hitPatterns, accept);
+        } });
+    }
+
+    return tasks;
+}
+
+vector<SearchTask> Document::phraseSearchTasks(
+    const string& pattern,
+    CaseMode caseMode,
+    vector<vector<SearchResultLocation>>* pageResults
+) const
+{
+    vector<SearchTask> tasks;
+
+    shared_ptr<const PhrasePattern> phrase = make_shared<const PhrasePattern>(normalizeForSearch(pattern, true));
+
+    if (phrase->empty())
+    {
+        return tasks;
+    }
+
+    bool caseSensitive = caseMode == CaseMode::Sensitive || (caseMode == CaseMode::Smart && hasUpperCase(pattern));
+    shared_ptr<const PhrasePattern> exact;
+
+    if (caseSensitive)
+    {
+        exact = make_shared<const PhrasePattern>(normalizeForSearch(pattern, false));
+    }
+
+    auto accept = [exact](const TextSpan&, i32, string_view match) -> bool {
+        return !exact || exact->matches(normalizeForSearch(match, false));
+    };
+
+    // Phrases can carry on into later pages so every page is scanned, each for the matches starting on it
+    for (i32 pageIndex = 0; pageIndex < static_cast<i32>(_pages.size()); pageIndex++)
+    {
+        tasks.push_back({ pageIndex, [this, phrase, accept, pageIndex, pageResults]() -> void {
+            vector<TextSpan> hits = phrase->find(searchText->text(), pageSearchOffset(pageIndex), pageSearchOffset(pageIndex + 1));
+
+            pageResults->at(pageIndex) = placeHits(pageIndex, hits, {}, accept);
+        } });
+    }
+
+    return tasks;
+}
+
+SearchResults Document::mergeSearchResults(vector<vector<SearchResultLocation>>&& pageResults)
+{
+    SearchResults results;
+
+    for (const vector<SearchResultLocation>& page : pageResults)
+    {
+        for (const SearchResultLocation& result : page)
+        {
+            results.add(result);
+        }
     }
 
     return results;
 }
 
-const vector<Page>& Document::pages() const
+const pmr::vector<Page>& Document::pages() const
 {
     return _pages;
 }
 
-const vector<Outline>& Document::outline() const
+const pmr::vector<Outline>& Document::outline() const
 {
     return _outline;
 }
 
+const string& Document::text() const
+{
+    return _text;
+}
+
+SearchResultLocation Document::locateText(size_t offset) const
+{
+    size_t block = blockAt(offset);
+    i32 pageIndex = pageAt(block);
+    size_t blockOffset = blockTextOffsets.at(block);
+
+    return SearchResultLocation(
+        pageIndex,
+        block - pageBlockOffsets.at(pageIndex),
+        charwiseSize(string_view(_text).substr(blockOffset, offset - blockOffset))
+    );
+}
+
+vector<size_t> Document::lineBreaksOf(i32 pageIndex) const
+{
+    size_t firstBlock = pageBlockOffsets.at(pageIndex);
+    size_t endBlock = static_cast<size_t>(pageIndex) + 1 < pageBlockOffsets.size() ? pageBlockOffsets.at(pageIndex + 1) : blockTextOffsets.size();
+
+    size_t start = firstBlock < blockTextOffsets.size() ? blockTextOffsets.at(firstBlock) : _text.size();
+    size_t end = endBlock < blockTextOffsets.size() ? blockTextOffsets.at(endBlock) : _text.size();
+
+    vector<size_t> breaks;
+
+    for (size_t i = start; i < end; i++)
+    {
+        // The null byte after a block's last line break doesn't start another line
+        if (_text.at(i) == '\n' || (_text.at(i) == '\0' && (i == 0 || _text.at(i - 1) != '\n')))
+        {
+            breaks.push_back(i);
+        }
+    }
+
+    return breaks;
+}
+
+string_view Document::lineOf(const SearchResultLocation& result, const vector<size_t>& pageLineBreaks, i32* line, i32* column) const
+{
+    string_view text(_text);
+
+    size_t blockOffset = blockTextOffsets.at(pageBlockOffsets.at(result.pageIndex) + result.blockIndex);
+    size_t offset = blockOffset + charwiseOffset(text.substr(blockOffset), result.characterIndex);
+
+    // Blocks end in null bytes so the line never starts before the page does
+    size_t lineStart = offset > 0 ? text.find_last_of(lineBreaks, offset - 1) + 1 : 0;
+    size_t lineEnd = text.find_first_of(lineBreaks, offset);
+
+    *line = lower_bound(pageLineBreaks.begin(), pageLineBreaks.end(), lineStart) - pageLineBreaks.begin() + 1;
+    *column = charwiseSize(text.substr(lineStart, offset - lineStart)) + 1;
+
+    return text.substr(lineStart, lineEnd - lineStart);
+}
+
+bool Document::indexed() const
+{
+    lock_guard<mutex> lock(index->lock);
+
+    return index->suffixArray != nullptr;
+}
+
+size_t Document::indexSize() const
+{
+    lock_guard<mutex> lock(index->lock);
+
+    return index->suffixArray ? index->suffixArray->size() : 0;
+}
+
+chrono::milliseconds Document::indexBuildTime() const
+{
+    lock_guard<mutex> lock(index->lock);
+
+    return index->buildTime;
+}
+
+bool Document::indexCached() const
+{
+    lock_guard<mutex> lock(index->lock);
+
+    return index->cached;
+}
+
+size_t Document::trigramIndexSize() const
+{
+    return trigrams.size();
+}
+
+size_t Document::searchTextSize() const
+{
+    return searchText->size();
+}
+
 i32 Document::outlinePageIndexAt(i32 selectIndex) const
 {
     i32 y = 0;
@@ -145,3 +715,168 @@ i32 Document::outlineHeight() const
 
     return height;
 }
+
+// Places each line of a match after the first, from the break at offset up to end
+vector<SearchResultLocation> Document::placeContinuations(size_t offset, size_t end, i32 pattern) const
+{
+    vector<SearchResultLocation> continuations;
+
+    string_view text = string_view(_text).substr(0, end);
+
+    while (offset < end)
+    {
+        offset++;
+
+        size_t lineEnd = min(text.find_first_of(lineBreaks, offset), end);
+
+        if (lineEnd > offset)
+        {
+            size_t block = blockAt(offset);
+            i32 pageIndex = pageAt(block);
+            size_t blockOffset = blockTextOffsets.at(block);
+
+            SearchResultLocation continuation(
+                pageIndex,
+                block - pageBlockOffsets.at(pageIndex),
+                charwiseSize(text.substr(blockOffset, offset - blockOffset)),
+                0,
+                0,
+                charwiseSize(text.substr(offset, lineEnd - offset)),
+                pattern
+            );
+
+            tie(continuation.x, continuation.y) = _pages.at(pageIndex).locateSearchInGrid(continuation);
+
+            continuations.push_back(move(continuation));
+        }
+
+        offset = lineEnd;
+    }
+
+    return continuations;
+}
+
+size_t Document::pageSearchOffset(i32 pageIndex) const
+{
+    if (pageIndex >= static_cast<i32>(pageSearchOffsets.size()))
+    {
+        return searchText->text().size();
+    }
+
+    return pageSearchOffsets.at(pageIndex);
+}
+
+size_t Document::blockAt(size_t offset) const
+{
+    return (upper_bound(blockTextOffsets.begin(), blockTextOffsets.end(), offset) - blockTextOffsets.begin()) - 1;
+}
+
+i32 Document::pageAt(size_t block) const
+{
+    // Pages without blocks share an offset with the next page, taking the last match skips them
+    return (upper_bound(pageBlockOffsets.begin(), pageBlockOffsets.end(), block) - pageBlockOffsets.begin()) - 1;
+}
+
+vector<size_t> Document::scanPage(i32 pageIndex, const string& search) const
+{
+    vector<size_t> hits;
+
+    // Matches never cross a page since every block ends in a null byte
+    string_view text = string_view(searchText->text()).substr(0, pageSearchOffset(pageIndex + 1));
+
+    size_t offset = pageSearchOffset(pageIndex);
+
+    while (true)
+    {
+        size_t index = findSubstring(text, search, offset);
+
+        if (index == string::npos)
+        {
+            break;
+        }
+
+        hits.push_back(index);
+
+        offset = index + 1;
+    }
+
+    return hits;
+}
+
+vector<SearchResultLocation> Document::placeHits(
+    i32 pageIndex,
+    const vector<TextSpan>& hits,
+    const vector<i32>& hitPatterns,
+    const function<bool(const TextSpan& hit, i32 pattern, string_view match)>& accept
+) const
+{
+    vector<SearchResultLocation> results;
+
+    // Character indices are advanced incrementally from the last hit in the same block
+    size_t block = string::npos;
+    size_t countedOffset = 0;
+    size_t characterIndex = 0;
+    size_t end = 0;
+
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        const TextSpan& hit = hits.at(i);
+        i32 pattern = !hitPatterns.empty() ? hitPatterns.at(i) : 0;
+
+        size_t index = searchText->originalStart(hit.offset);
+        size_t indexEnd = searchText->originalEnd(hit.offset + hit.size);
+
+        string_view match = string_view(_text).substr(index, indexEnd - index);
+
+        if (!accept(hit, pattern, match))
+        {
+            continue;
+        }
+
+        // Overlapping hits are kept for refining longer searches but only the first of each is shown
+        if (index < end)
+        {
+            continue;
+        }
+
+        end = indexEnd;
+
+        size_t hitBlock = blockAt(index);
+
+        if (hitBlock != block)
+        {
+            block = hitBlock;
+            countedOffset = blockTextOffsets.at(block);
+            characterIndex = 0;
+        }
+
+        characterIndex += charwiseSize(string_view(_text).substr(countedOffset, index - countedOffset));
+        countedOffset = index;
+
+        size_t lineEnd = match.find_first_of(lineBreaks);
+
+        SearchResultLocation result(
+            pageIndex,
+            block - pageBlockOffsets.at(pageIndex),
+            characterIndex,
+            0,
+            0,
+            charwiseSize(match.substr(0, lineEnd)),
+            pattern
+        );
+
+        if (lineEnd != string::npos && gridGenerated)
+        {
+            result.continuations = placeContinuations(index + lineEnd, indexEnd, pattern);
+        }
+
+        results.push_back(move(result));
+    }
+
+    if (results.empty() || !gridGenerated)
+    {
+        return results;
+    }
+
+    return _pages.at(pageIndex).placeSearchResults(move(results));
+}
@@ -21,26 +21,138 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "types.hpp"
 #include "page.hpp"
 #include "outline.hpp"
+#include "suffix_array.hpp"
+#include "trigram_index.hpp"
+#include "search_text.hpp"
+#include "search_results.hpp"
+
+// Searches one page, safe to run on any thread alongside the tasks for other pages
+struct SearchTask
+{
+    i32 pageIndex;
+    function<void()> run;
+};
 
 class Document
 {
 public:
     Document();
+    Document(const Document& rhs) = delete;
+    Document(Document&& rhs) = default;
 
-    void add(const Page& page);
-    void setOutline(const vector<Outline>& outline);
+    Document& operator=(const Document& rhs) = delete;
+    Document& operator=(Document&& rhs) = delete;
+
+    // Build the outline tree with this so setOutline can take it over as-is
+    pmr::polymorphic_allocator<> allocator() const;
+    void reserve(size_t count);
+    void add(Page&& page);
+    void setOutline(pmr::vector<Outline>&& outline);
     void generateGrid();
+    // Builds the search index in the background, or maps the one saved for source, no pages may be added afterwards
+    void startIndexing(const filesystem::path& source);
+    // Maps the search index saved for source if there is one, without building it
+    void loadIndex(const filesystem::path& source);
+
+    SearchResults search(const string& search, CaseMode caseMode = CaseMode::Sensitive) const;
+    /*
+     * One independent task per page that could match, each filling in its own entries of pageHits and
+     * pageResults. pageHits receives the case-folded text offset of every match including overlapping
+     * ones, passing them back as previousHits for a search that extends this one only verifies those.
+     */
+    vector<SearchTask> searchTasks(
+        const string& search,
+        CaseMode caseMode,
+        const vector<vector<size_t>>* previousHits,
+        vector<vector<size_t>>* pageHits,
+        vector<vector<SearchResultLocation>>* pageResults
+    ) const;
+    static SearchResults mergeSearchResults(vector<vector<SearchResultLocation>>&& pageResults);
 
-    vector<SearchResultLocation> search(const string& search) const;
+    const pmr::vector<Page>& pages() const;
+    const pmr::vector<Outline>& outline() const;
+    const string& text() const;
+    SearchResultLocation locateText(size_t offset) const;
+    // Offsets in text() of the line breaks on a page, found once per page for lineOf
+    vector<size_t> lineBreaksOf(i32 pageIndex) const;
+    // The line a result starts on, with its line and column on the page counting from one, given its page's line breaks
+    string_view lineOf(const SearchResultLocation& result, const vector<size_t>& pageLineBreaks, i32* line, i32* column) const;
 
-    const vector<Page>& pages() const;
-    const vector<Outline>& outline() const;
+    bool indexed() const;
+    size_t indexSize() const;
+    chrono::milliseconds indexBuildTime() const;
+    // Whether the index was loaded from the cache rather than built
+    bool indexCached() const;
+    size_t trigramIndexSize() const;
+    size_t searchTextSize() const;
 
     i32 outlinePageIndexAt(i32 selectIndex) const;
     i32 outlineWidth() const;
     i32 outlineHeight() const;
 
 private:
-    vector<Page> _pages;
-    vector<Outline> _outline;
+    struct SearchIndex
+    {
+        mutex lock;
+        shared_ptr<const SuffixArray> suffixArray;
+        chrono::milliseconds buildTime;
+        bool cached;
+    };
+
+    // Owns the page list and outline so they can be released in one go, must outlive both
+    unique_ptr<pmr::monotonic_buffer_resource> arena;
+    pmr::vector<Page> _pages;
+    pmr::vector<Outline> _outline;
+    // Every block's text back to back, separated by null bytes so no match can span two blocks
+    string _text;
+    // Byte offset in _text of each block, in page then block order
+    vector<size_t> blockTextOffsets;
+    // Index into blockTextOffsets of each page's first block
+    vector<size_t> pageBlockOffsets;
+    // What searches and the indices run against, shared with the thread building the suffix array
+    shared_ptr<SearchText> searchText;
+    // Offset in searchText of each page's text
+    vector<size_t> pageSearchOffsets;
+    // Shared with the thread building it so the document can move while that runs
+    shared_ptr<SearchIndex> index;
+    // Narrows down which pages of searchText to scan until the suffix array is ready
+    TrigramIndex trigrams;
+    // Results are only placed on screen once there is a grid, headless searches go without
+    bool gridGenerated;
+
+    vector<SearchTask> regexSearchTasks(
+        const string& pattern,
+        CaseMode caseMode,
+        vector<vector<SearchResultLocation>>* pageResults
+    ) const;
+    vector<SearchTask> fuzzySearchTasks(
+        const string& pattern,
+        i32 distance,
+        CaseMode caseMode,
+        vector<vector<SearchResultLocation>>* pageResults
+    ) const;
+    vector<SearchTask> multipleSearchTasks(
+        const vector<string>& patterns,
+        CaseMode caseMode,
+        vector<vector<SearchResultLocation>>* pageResults
+    ) const;
+    vector<SearchTask> phraseSearchTasks(
+        const string& pattern,
+        CaseMode caseMode,
+        vector<vector<SearchResultLocation>>* pageResults
+    ) const;
+    vector<size_t> scanPage(i32 pageIndex, const string& search) const;
+    // Keeps the hits that accept approves of, given the pattern each is of if there are several and the original text it covers
+    vector<SearchResultLocation> placeHits(
+        i32 pageIndex,
+        const vector<TextSpan>& hits,
+        const vector<i32>& hitPatterns,
+        const function<bool(const TextSpan& hit, i32 pattern, string_view match)>& accept
+    ) const;
+
+    vector<SearchResultLocation> placeContinuations(size_t offset, size_t end, i32 pattern) const;
+
+    size_t pageSearchOffset(i32 pageIndex) const;
+    size_t blockAt(size_t offset) const;
+    i32 pageAt(size_t block) const;
 };
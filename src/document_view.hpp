@@ -19,7 +19,7 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include "types.hpp"
-#include "search_result_location.hpp"
+#include "search_results.hpp"
 
 struct DocumentView
 {
@@ -29,7 +29,7 @@ struct DocumentView
     i32 scrollIndex;
     i32 panIndex;
     size_t searchResultIndex;
-    vector<SearchResultLocation> searchResults;
+    SearchResults searchResults;
     bool viewingOutline;
     i32 outlineSelectIndex;
     i32 outlineScrollIndex;
@@ -0,0 +1,392 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "extraction_pool.hpp"
+#include "constants.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+static bool writeAll(int fd, const void* data, size_t size)
+{
+    const char* p = static_cast<const char*>(data);
+
+    while (size > 0)
+    {
+        ssize_t written = write(fd, p, size);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (written <= 0)
+        {
+            return false;
+        }
+
+        p += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+static bool readAll(int fd, void* data, size_t size, chrono::steady_clock::time_point deadline)
+{
+    char* p = static_cast<char*>(data);
+
+    while (size > 0)
+    {
+        // A worker that stalls partway through a page is as stuck as one that never starts it
+        pollfd pfd = { fd, POLLIN, 0 };
+        chrono::milliseconds timeout = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+
+        int ready = poll(&pfd, 1, max<i64>(timeout.count(), 0));
+
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (ready <= 0)
+        {
+            return false;
+        }
+
+        ssize_t consumed = read(fd, p, size);
+
+        if (consumed < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (consumed <= 0)
+        {
+            return false;
+        }
+
+        p += consumed;
+        size -= consumed;
+    }
+
+    return true;
+}
+
+template<typename T>
+static void append(string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool writePage(int fd, const Page& page)
+{
+    string buffer;
+
+    append<u32>(buffer, page.blocks().size());
+
+    for (const Block& block : page.blocks())
+    {
+        append<f64>(buffer, block.left());
+        append<f64>(buffer, block.right());
+        append<f64>(buffer, block.top());
+        append<f64>(buffer, block.bottom());
+        append<u32>(buffer, block.text().size());
+        buffer += block.text();
+    }
+
+    u32 size = buffer.size();
+
+    // Written in one go so the reader never waits on a half-finished page
+    return writeAll(fd, &size, sizeof(size)) && writeAll(fd, buffer.data(), buffer.size());
+}
+
+bool readPage(int fd, Page& page, chrono::steady_clock::time_point deadline)
+{
+    u32 size;
+
+    if (!readAll(fd, &size, sizeof(size), deadline))
+    {
+        return false;
+    }
+
+    string buffer(size, '\0');
+
+    if (!readAll(fd, buffer.data(), buffer.size(), deadline))
+    {
+        return false;
+    }
+
+    size_t offset = 0;
+
+    auto consume = [&buffer, &offset](void* data, size_t size) -> bool {
+        if (offset + size > buffer.size())
+        {
+            return false;
+        }
+
+        memcpy(data, buffer.data() + offset, size);
+        offset += size;
+
+        return true;
+    };
+
+    u32 blockCount;
+
+    if (!consume(&blockCount, sizeof(blockCount)))
+    {
+        return false;
+    }
+
+    page.reserve(blockCount);
+
+    for (u32 i = 0; i < blockCount; i++)
+    {
+        f64 left;
+        f64 right;
+        f64 top;
+        f64 bottom;
+        u32 textSize;
+
+        if (
+            !consume(&left, sizeof(left)) ||
+            !consume(&right, sizeof(right)) ||
+            !consume(&top, sizeof(top)) ||
+            !consume(&bottom, sizeof(bottom)) ||
+            !consume(&textSize, sizeof(textSize)) ||
+            offset + textSize > buffer.size()
+        )
+        {
+            return false;
+        }
+
+        page.add(Block(left, right, top, bottom, string_view(buffer).substr(offset, textSize), page.allocator()));
+        offset += textSize;
+    }
+
+    return true;
+}
+
+ExtractionPool::ExtractionPool(size_t workerCount, const vector<string>& arguments)
+    : arguments(arguments)
+    , workers(workerCount, Worker{ -1, -1, -1, -1, {} })
+{
+    for (Worker& worker : workers)
+    {
+        start(worker);
+    }
+}
+
+ExtractionPool::~ExtractionPool()
+{
+    for (Worker& worker : workers)
+    {
+        stop(worker);
+    }
+}
+
+void ExtractionPool::extract(Document& document, i32 pageCount)
+{
+    vector<optional<Page>> pages(pageCount);
+    vector<i32> attempts(pageCount, 0);
+    deque<i32> queue;
+
+    for (i32 i = 0; i < pageCount; i++)
+    {
+        queue.push_back(i);
+    }
+
+    i32 remaining = pageCount;
+
+    auto fail = [&](Worker& worker) -> void {
+        i32 pageIndex = worker.pageIndex;
+
+        stop(worker);
+        start(worker);
+
+        attempts.at(pageIndex)++;
+
+        if (attempts.at(pageIndex) < extractionAttempts)
+        {
+            queue.push_front(pageIndex);
+        }
+        else
+        {
+            pages.at(pageIndex).emplace();
+            pages.at(pageIndex)->markFailed();
+            remaining--;
+        }
+    };
+
+    while (remaining > 0)
+    {
+        for (Worker& worker : workers)
+        {
+            if (worker.pageIndex >= 0 || queue.empty())
+            {
+                continue;
+            }
+
+            worker.pageIndex = queue.front();
+            worker.start = chrono::steady_clock::now();
+            queue.pop_front();
+
+            if (!writeAll(worker.commandFD, &worker.pageIndex, sizeof(worker.pageIndex)))
+            {
+                fail(worker);
+            }
+        }
+
+        vector<pollfd> fds;
+        vector<Worker*> busy;
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        chrono::milliseconds timeout = extractionTimeout;
+
+        for (Worker& worker : workers)
+        {
+            if (worker.pageIndex < 0)
+            {
+                continue;
+            }
+
+            fds.push_back({ worker.resultFD, POLLIN, 0 });
+            busy.push_back(&worker);
+
+            timeout = min(timeout, chrono::duration_cast<chrono::milliseconds>(worker.start + extractionTimeout - now));
+        }
+
+        if (busy.empty())
+        {
+            continue;
+        }
+
+        poll(fds.data(), fds.size(), max<i64>(timeout.count(), 0));
+
+        now = chrono::steady_clock::now();
+
+        for (size_t i = 0; i < busy.size(); i++)
+        {
+            Worker& worker = *busy.at(i);
+
+            if (fds.at(i).revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                optional<Page>& page = pages.at(worker.pageIndex);
+
+                page.emplace();
+
+                if (readPage(worker.resultFD, *page, worker.start + extractionTimeout))
+                {
+                    worker.pageIndex = -1;
+                    remaining--;
+                }
+                else
+                {
+                    fail(worker);
+                }
+            }
+            else if (now - worker.start >= extractionTimeout)
+            {
+                fail(worker);
+            }
+        }
+    }
+
+    for (optional<Page>& page : pages)
+    {
+        document.add(move(*page));
+    }
+}
+
+void ExtractionPool::start(Worker& worker)
+{
+    int commandFDs[2];
+    int resultFDs[2];
+
+    // Closed in every program this process runs, so a worker only holds the two ends it is given as stdin and stdout
+    if (pipe2(commandFDs, O_CLOEXEC) != 0)
+    {
+        throw runtime_error("Failed to create extraction worker pipe.");
+    }
+
+    if (pipe2(resultFDs, O_CLOEXEC) != 0)
+    {
+        close(commandFDs[0]);
+        close(commandFDs[1]);
+        throw runtime_error("Failed to create extraction worker pipe.");
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, commandFDs[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, resultFDs[1], STDOUT_FILENO);
+
+    vector<char*> argv;
+    argv.reserve(arguments.size() + 2);
+    argv.push_back(const_cast<char*>(selfExecutablePath));
+
+    for (const string& argument : arguments)
+    {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+
+    argv.push_back(nullptr);
+
+    /*
+     * Other threads may be loading or searching and hold locks at this point that a plain fork would copy held
+     * and never release, so the worker starts this program afresh rather than carrying on from a copy of it.
+     */
+    pid_t pid;
+    int error = posix_spawn(&pid, selfExecutablePath, &actions, nullptr, argv.data(), environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+
+    close(commandFDs[0]);
+    close(resultFDs[1]);
+
+    if (error != 0)
+    {
+        close(commandFDs[1]);
+        close(resultFDs[0]);
+        throw runtime_error("Failed to start extraction worker.");
+    }
+
+    worker.pid = pid;
+    worker.commandFD = commandFDs[1];
+    worker.resultFD = resultFDs[0];
+    worker.pageIndex = -1;
+}
+
+void ExtractionPool::stop(Worker& worker)
+{
+    if (worker.pid <= 0)
+    {
+        return;
+    }
+
+    close(worker.commandFD);
+    close(worker.resultFD);
+
+    // A worker holds nothing that needs cleaning up, so it is killed rather than trusted to exit once its pipe closes
+    kill(worker.pid, SIGKILL);
+    waitpid(worker.pid, nullptr, 0);
+
+    worker.pid = -1;
+    worker.commandFD = -1;
+    worker.resultFD = -1;
+    worker.pageIndex = -1;
+}
@@ -0,0 +1,59 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "document.hpp"
+
+#include <sys/types.h>
+
+bool writePage(int fd, const Page& page);
+// Gives up on a page that hasn't fully arrived by the deadline
+bool readPage(int fd, Page& page, chrono::steady_clock::time_point deadline);
+
+// Extracts pages in worker processes so a page that crashes or hangs the extractor only takes down its worker
+class ExtractionPool
+{
+public:
+    // Each worker runs this program again with the arguments given, reading page indices from stdin and writing pages to stdout
+    ExtractionPool(size_t workerCount, const vector<string>& arguments);
+    ExtractionPool(const ExtractionPool& rhs) = delete;
+    ExtractionPool(ExtractionPool&& rhs) = delete;
+    ~ExtractionPool();
+
+    ExtractionPool& operator=(const ExtractionPool& rhs) = delete;
+    ExtractionPool& operator=(ExtractionPool&& rhs) = delete;
+
+    void extract(Document& document, i32 pageCount);
+
+private:
+    struct Worker
+    {
+        pid_t pid;
+        int commandFD;
+        int resultFD;
+        i32 pageIndex;
+        chrono::steady_clock::time_point start;
+    };
+
+    vector<string> arguments;
+    vector<Worker> workers;
+
+    void start(Worker& worker);
+    void stop(Worker& worker);
+};
@@ -0,0 +1,188 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "fuzzy_pattern.hpp"
+
+static constexpr size_t blockBits = 64;
+
+FuzzyPattern::FuzzyPattern(string_view pattern, i32 distance)
+    : patternSize(pattern.size())
+    , _distance(clamp<i32>(distance, 0, max<i32>(static_cast<i32>(pattern.size()) - 1, 0) / 2))
+    , blocks((pattern.size() + blockBits - 1) / blockBits)
+    , forwardMasks(256 * blocks, 0)
+    , reverseMasks(256 * blocks, 0)
+{
+    for (size_t i = 0; i < patternSize; i++)
+    {
+        u8 forwardByte = pattern[i];
+        u8 reverseByte = pattern[patternSize - 1 - i];
+
+        forwardMasks.at(forwardByte * blocks + i / blockBits) |= 1ull << (i % blockBits);
+        reverseMasks.at(reverseByte * blocks + i / blockBits) |= 1ull << (i % blockBits);
+    }
+}
+
+i32 FuzzyPattern::distance() const
+{
+    return _distance;
+}
+
+vector<TextSpan> FuzzyPattern::find(string_view text, size_t start, size_t end) const
+{
+    vector<TextSpan> matches;
+
+    if (patternSize == 0)
+    {
+        return matches;
+    }
+
+    Column column = initialColumn();
+
+    // Where the next match may start, past the last one and any null byte
+    size_t earliest = start;
+
+    for (size_t i = start; i < end; i++)
+    {
+        u8 c = text[i];
+
+        if (c == '\0')
+        {
+            column = initialColumn();
+            earliest = i + 1;
+            continue;
+        }
+
+        advance(&column, forwardMasks, c, false);
+
+        if (column.score > _distance)
+        {
+            continue;
+        }
+
+        // The first end within distance is often early, so find where it starts and then its best end from there
+        size_t offset = matchStart(text, i + 1 - min(i + 1 - earliest, patternSize + _distance), i + 1);
+
+        size_t limit = offset + min(end - offset, patternSize + _distance);
+        size_t matchEnd = this->matchEnd(text, offset, limit);
+
+        matches.push_back({ offset, matchEnd - offset });
+
+        column = initialColumn();
+        earliest = matchEnd;
+        i = matchEnd - 1;
+    }
+
+    return matches;
+}
+
+i32 FuzzyPattern::distanceTo(string_view text) const
+{
+    Column column = initialColumn();
+
+    for (char c : text)
+    {
+        advance(&column, forwardMasks, c, true);
+    }
+
+    return column.score;
+}
+
+FuzzyPattern::Column FuzzyPattern::initialColumn() const
+{
+    return { vector<u64>(blocks, ~0ull), vector<u64>(blocks, 0), static_cast<i32>(patternSize) };
+}
+
+void FuzzyPattern::advance(Column* column, const vector<u64>& masks, u8 c, bool anchored) const
+{
+    // The change in distance carried down from the block above, the top row only grows when anchored
+    i32 carry = anchored ? 1 : 0;
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        u64& positive = column->positive.at(b);
+        u64& negative = column->negative.at(b);
+
+        u64 equal = masks.at(c * blocks + b);
+        u64 carryNegative = carry < 0 ? 1 : 0;
+        u64 carryPositive = carry > 0 ? 1 : 0;
+
+        u64 verticalSet = equal | negative;
+        equal |= carryNegative;
+
+        u64 horizontalSet = (((equal & positive) + positive) ^ positive) | equal;
+        u64 horizontalPositive = negative | ~(horizontalSet | positive);
+        u64 horizontalNegative = positive & horizontalSet;
+
+        // The last block's bottom row is the pattern's last byte
+        u64 bottom = b + 1 < blocks ? 1ull << (blockBits - 1) : 1ull << ((patternSize - 1) % blockBits);
+
+        carry = (horizontalPositive & bottom ? 1 : 0) - (horizontalNegative & bottom ? 1 : 0);
+
+        horizontalPositive = (horizontalPositive << 1) | carryPositive;
+        horizontalNegative = (horizontalNegative << 1) | carryNegative;
+
+        positive = horizontalNegative | ~(verticalSet | horizontalPositive);
+        negative = horizontalPositive & verticalSet;
+    }
+
+    column->score += carry;
+}
+
+// Reads on from the start of a match for the end with the lowest distance, preferring the longest
+size_t FuzzyPattern::matchEnd(string_view text, size_t start, size_t end) const
+{
+    Column column = initialColumn();
+
+    i32 best = column.score;
+    size_t offset = start;
+
+    for (size_t i = start; i < end && text[i] != '\0'; i++)
+    {
+        advance(&column, forwardMasks, text[i], true);
+
+        if (column.score <= best)
+        {
+            best = column.score;
+            offset = i + 1;
+        }
+    }
+
+    return offset;
+}
+
+// Reads back from the end of a match for the start with the lowest distance, preferring the longest
+size_t FuzzyPattern::matchStart(string_view text, size_t start, size_t end) const
+{
+    Column column = initialColumn();
+
+    i32 best = column.score;
+    size_t offset = end;
+
+    for (size_t i = end; i > start; i--)
+    {
+        advance(&column, reverseMasks, text[i - 1], true);
+
+        if (column.score <= best)
+        {
+            best = column.score;
+            offset = i - 1;
+        }
+    }
+
+    return offset;
+}
@@ -0,0 +1,63 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+
+/*
+ * A pattern found within a number of edits (insertions, deletions or substitutions of bytes) by
+ * Myers' bit-parallel algorithm, which advances a whole column of the edit distance table per byte
+ * of text using one machine word per 64 bytes of pattern. Matches never cross null bytes.
+ */
+class FuzzyPattern
+{
+public:
+    // The distance is limited to less than half the pattern so it can never match almost anything
+    FuzzyPattern(string_view pattern, i32 distance);
+
+    i32 distance() const;
+
+    // Non-overlapping matches in text between start and end, each extended as far as its distance allows
+    vector<TextSpan> find(string_view text, size_t start, size_t end) const;
+    // Edit distance between the whole of text and the pattern
+    i32 distanceTo(string_view text) const;
+
+private:
+    // One column of the edit distance table as vertical differences between rows, and its bottom row
+    struct Column
+    {
+        vector<u64> positive;
+        vector<u64> negative;
+        i32 score;
+    };
+
+    size_t patternSize;
+    i32 _distance;
+    size_t blocks;
+    // Bits set where each byte appears in the pattern, and in the pattern reversed for finding match starts
+    vector<u64> forwardMasks;
+    vector<u64> reverseMasks;
+
+    Column initialColumn() const;
+    // Anchored columns charge for text skipped before the pattern, unanchored ones let it start anywhere
+    void advance(Column* column, const vector<u64>& masks, u8 c, bool anchored) const;
+    size_t matchStart(string_view text, size_t start, size_t end) const;
+    size_t matchEnd(string_view text, size_t start, size_t end) const;
+};
@@ -0,0 +1,150 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "grep.hpp"
+#include "constants.hpp"
+#include "loader.hpp"
+#include "search_query.hpp"
+#include "thread_pool.hpp"
+
+// One file's lines, held back until every file before it has been written so output follows argument order
+struct GrepOutput
+{
+    string lines;
+    string error;
+    bool matched;
+    bool done;
+};
+
+static GrepOutput grepFile(const string& search, CaseMode caseMode, const filesystem::path& path)
+{
+    GrepOutput output = { "", "", false, true };
+
+    if (!filesystem::is_regular_file(path))
+    {
+        output.error = format("{}: {}: No such file", programName, path.string());
+        return output;
+    }
+
+    try
+    {
+        Document document = loadDocumentText(path);
+
+        SearchResults results = document.search(search, caseMode);
+
+        vector<size_t> lineBreaks;
+        i32 lineBreaksPage = -1;
+
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            SearchResultLocation result = results.at(i);
+
+            // Results come in page order so each page's line breaks are only found once
+            if (result.pageIndex != lineBreaksPage)
+            {
+                lineBreaks = document.lineBreaksOf(result.pageIndex);
+                lineBreaksPage = result.pageIndex;
+            }
+
+            i32 line;
+            i32 column;
+            string_view text = document.lineOf(result, lineBreaks, &line, &column);
+
+            output.lines += format("{}:{}:{}:{}:{}\n", path.string(), result.pageIndex + 1, line, column, text);
+        }
+
+        output.matched = !results.empty();
+    }
+    catch (const exception& e)
+    {
+        output.error = format("{}: {}: {}", programName, path.string(), e.what());
+    }
+
+    return output;
+}
+
+int grep(const string& search, const vector<filesystem::path>& paths)
+{
+    SearchQuery query = parseSearch(search);
+
+    string error = searchError(query);
+
+    if (!error.empty())
+    {
+        cerr << format("{}: Can't search for '{}': {}", programName, search, error) << endl;
+        return 2;
+    }
+
+    CaseMode caseMode = caseModeFromEnvironment();
+
+    vector<GrepOutput> outputs(paths.size(), { "", "", false, false });
+    mutex lock;
+    size_t written = 0;
+    bool matched = false;
+    bool failed = false;
+    // Nothing is left to do once whatever reads the output has gone away
+    atomic<bool> outputClosed = false;
+
+    // Each file is loaded and searched on its own thread, the calling thread takes one too
+    ThreadPool pool(min<size_t>(paths.size(), max(thread::hardware_concurrency(), 1u)) - 1);
+
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        pool.submit([&, i]() -> void {
+            GrepOutput output = !outputClosed ? grepFile(search, caseMode, paths.at(i)) : GrepOutput{ "", "", false, true };
+
+            lock_guard<mutex> guard(lock);
+
+            outputs.at(i) = move(output);
+
+            while (written < outputs.size() && outputs.at(written).done)
+            {
+                GrepOutput& next = outputs.at(written);
+
+                cout << next.lines << flush;
+
+                if (!cout)
+                {
+                    outputClosed = true;
+                    failed = true;
+                }
+
+                if (!next.error.empty())
+                {
+                    cerr << next.error << endl;
+                }
+
+                matched = matched || next.matched;
+                failed = failed || !next.error.empty();
+
+                // Released as soon as it is written
+                next = { "", "", false, true };
+                written++;
+            }
+        });
+    }
+
+    pool.wait();
+
+    if (failed)
+    {
+        return 2;
+    }
+
+    return matched ? 0 : 1;
+}
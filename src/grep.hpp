@@ -0,0 +1,27 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+/*
+ * Searches the files without opening the display, printing each result as file:page:line:column:line text.
+ * Returns 0 if anything matched, 1 if nothing did and 2 if a file or the search was invalid, like grep.
+ */
+int grep(const string& search, const vector<filesystem::path>& paths);
@@ -0,0 +1,152 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "index_cache.hpp"
+#include "constants.hpp"
+#include "mapped_file.hpp"
+
+u64 hashBytes(string_view data)
+{
+    return hashBytes(hashOffsetBasis, data);
+}
+
+u64 hashBytes(u64 hash, string_view data)
+{
+    for (char c : data)
+    {
+        hash ^= static_cast<u8>(c);
+        hash *= hashPrime;
+    }
+
+    return hash;
+}
+
+static filesystem::path indexCacheDirectory()
+{
+    const char* cacheHome = getenv(cacheHomeVariable);
+    const char* home = getenv(homeVariable);
+
+    filesystem::path directory;
+
+    if (cacheHome && *cacheHome)
+    {
+        directory = cacheHome;
+    }
+    else if (home && *home)
+    {
+        directory = filesystem::path(home) / defaultCacheDirectory;
+    }
+    else
+    {
+        return {};
+    }
+
+    directory /= programName;
+
+    error_code error;
+    filesystem::create_directories(directory, error);
+
+    if (error)
+    {
+        return {};
+    }
+
+    return directory;
+}
+
+filesystem::path indexCachePath(const filesystem::path& source)
+{
+    filesystem::path directory = indexCacheDirectory();
+
+    if (directory.empty())
+    {
+        return {};
+    }
+
+    MappedFile file(source);
+
+    if (!file.valid())
+    {
+        return {};
+    }
+
+    return directory / format("{:016x}{}", hashBytes(file.data()), indexFileExtension);
+}
+
+void touchIndexCache(const filesystem::path& path)
+{
+    error_code error;
+    filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), error);
+}
+
+void pruneIndexCache()
+{
+    filesystem::path directory = indexCacheDirectory();
+
+    if (directory.empty())
+    {
+        return;
+    }
+
+    filesystem::file_time_type now = filesystem::file_time_type::clock::now();
+    string temporaryMarker = string(indexFileExtension) + ".";
+
+    vector<tuple<filesystem::file_time_type, u64, filesystem::path>> indices;
+
+    error_code error;
+
+    for (filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        // Other processes may be pruning at the same time, a file gone missing is simply skipped
+        error_code fileError;
+
+        filesystem::file_time_type time = it->last_write_time(fileError);
+        u64 size = it->file_size(fileError);
+
+        if (fileError || !it->is_regular_file(fileError))
+        {
+            continue;
+        }
+
+        if (it->path().extension() == indexFileExtension)
+        {
+            indices.push_back({ time, size, it->path() });
+        }
+        // A save renames its temporary file into place within seconds, unless the process exits first
+        else if (it->path().filename().string().find(temporaryMarker) != string::npos && now - time > indexTemporaryFileAge)
+        {
+            filesystem::remove(it->path(), fileError);
+        }
+    }
+
+    // Most recently used first, processes that have a removed file mapped keep it until they unmap it
+    sort(indices.begin(), indices.end(), greater<>());
+
+    u64 total = 0;
+
+    for (const auto& [ time, size, path ] : indices)
+    {
+        if (now - time > indexCacheMaxAge || total + size > indexCacheSizeLimit)
+        {
+            filesystem::remove(path, error);
+            continue;
+        }
+
+        total += size;
+    }
+}
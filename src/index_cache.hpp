@@ -0,0 +1,32 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+// 64-bit FNV-1a, enough to tell files apart and notice corruption
+u64 hashBytes(string_view data);
+// Continues a hash over more data, giving the hash of all of it back to back
+u64 hashBytes(u64 hash, string_view data);
+// Where the search index of a document is saved, named after a hash of its contents, empty if there is nowhere to save it
+filesystem::path indexCachePath(const filesystem::path& source);
+// Marks a saved index as just used, so the ones used longest ago are removed first
+void touchIndexCache(const filesystem::path& path);
+// Removes temporary files saves never finished, then indices unused for too long or past the cache's total size
+void pruneIndexCache();
@@ -91,7 +91,7 @@ static bool gridOverlap(
 }
 
 static void recursiveLocate(
-    const vector<Block>& blocks,
+    const pmr::vector<Block>& blocks,
     vector<tuple<i32, i32>>& offsets,
     set<size_t>& traversed,
     size_t index
@@ -185,7 +185,7 @@ static void recursiveLocate(
     offsets.at(index) = { x, y };
 }
 
-vector<tuple<i32, i32>> locate(const vector<Block>& blocks)
+vector<tuple<i32, i32>> locate(const pmr::vector<Block>& blocks)
 {
     vector<tuple<i32, i32>> offsets(blocks.size(), { -1, -1 });
 
@@ -21,4 +21,4 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "types.hpp"
 #include "block.hpp"
 
-vector<tuple<i32, i32>> locate(const vector<Block>& blocks);
+vector<tuple<i32, i32>> locate(const pmr::vector<Block>& blocks);
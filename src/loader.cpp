@@ -20,20 +20,34 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "constants.hpp"
 #include "pdf_loader.hpp"
 
-Document loadDocument(const filesystem::path& path)
+static Document loadByExtension(const filesystem::path& path)
 {
-    Document document;
-
     if (path.extension() == pdfExtension)
     {
-        document = loadPDF(path);
+        return loadPDF(path);
     }
     else
     {
         throw runtime_error("Unknown file extension '" + path.extension().string() + "'.");
     }
+}
+
+Document loadDocument(const filesystem::path& path)
+{
+    // Documents own their arena and cannot be assigned, only constructed
+    Document document = loadByExtension(path);
 
     document.generateGrid();
+    document.startIndexing(path);
+
+    return document;
+}
+
+Document loadDocumentText(const filesystem::path& path)
+{
+    Document document = loadByExtension(path);
+
+    document.loadIndex(path);
 
     return document;
 }
@@ -21,3 +21,5 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "document.hpp"
 
 Document loadDocument(const filesystem::path& path);
+// Loads only what searching the text needs, leaving out the grid and only using a suffix array saved earlier
+Document loadDocumentText(const filesystem::path& path);
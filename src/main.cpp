@@ -19,6 +19,9 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "types.hpp"
 #include "constants.hpp"
 #include "controller.hpp"
+#include "memory_usage.hpp"
+#include "grep.hpp"
+#include "pdf_loader.hpp"
 
 static bool quit = false;
 
@@ -29,6 +32,28 @@ static void onInterrupt(int)
 
 int main(int argc, char** argv)
 {
+    // Once for the whole process, writing to an extraction worker that died or to a closed output must fail rather than kill us
+    signal(SIGPIPE, SIG_IGN);
+
+    // Started by an extraction pool rather than a user
+    if (argc == 3 && string(argv[1]) == extractionWorkerOption)
+    {
+        runExtractionWorker(argv[2]);
+        return 0;
+    }
+
+    // Headless searches keep stdout for their results alone
+    if (argc > 1 && string(argv[1]) == grepOption)
+    {
+        if (argc < 4)
+        {
+            cerr << format("Usage: {} {} pattern files...", argv[0], grepOption) << endl;
+            return 2;
+        }
+
+        return grep(argv[2], vector<filesystem::path>(argv + 3, argv + argc));
+    }
+
     cout << format("{} {}.{}.{}", programName, majorVersion, minorVersion, patchVersion) << endl;
     cout << "Copyright 2024 Amini Allight" << endl << endl;
     cout << "This program comes with ABSOLUTELY NO WARRANTY; This is free software, and you are welcome to redistribute it under certain conditions. See the included license for further details." << endl << endl;
@@ -36,6 +61,7 @@ int main(int argc, char** argv)
     if (argc == 1)
     {
         cerr << format("Usage: {} files...", argv[0]) << endl;
+        cerr << format("       {} {} pattern files...", argv[0], grepOption) << endl;
         return 1;
     }
 
@@ -47,8 +73,9 @@ int main(int argc, char** argv)
 
     for (int i = 1; i < argc; i++)
     {
+        resetPeakMemoryUsage();
         controller.open(argv[i]);
-        cout << i << "/" << (argc - 1) << endl;
+        cout << format("{}/{} (peak memory usage {} MiB)", i, argc - 1, peakMemoryUsage() / (1024 * 1024)) << endl;
     }
 
     controller.openDisplay();
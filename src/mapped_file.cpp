@@ -0,0 +1,70 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const filesystem::path& path)
+    : _data(nullptr)
+    , _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if (data != MAP_FAILED)
+        {
+            _data = data;
+            _size = info.st_size;
+        }
+    }
+
+    // The mapping outlives the descriptor
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data)
+    {
+        munmap(_data, _size);
+    }
+}
+
+bool MappedFile::valid() const
+{
+    return _data != nullptr;
+}
+
+string_view MappedFile::data() const
+{
+    return string_view(static_cast<const char*>(_data), _size);
+}
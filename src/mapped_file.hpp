@@ -0,0 +1,42 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+// A whole file mapped read-only, its pages are shared with every other process mapping the same file
+class MappedFile
+{
+public:
+    explicit MappedFile(const filesystem::path& path);
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile(MappedFile&& rhs) = delete;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    MappedFile& operator=(MappedFile&& rhs) = delete;
+
+    // False if the file is empty or couldn't be opened or mapped
+    bool valid() const;
+    string_view data() const;
+
+private:
+    void* _data;
+    size_t _size;
+};
@@ -0,0 +1,51 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "memory_usage.hpp"
+
+void resetPeakMemoryUsage()
+{
+    // Writing 5 here resets the peak resident set size reported in /proc/self/status
+    ofstream file("/proc/self/clear_refs");
+
+    file << "5";
+}
+
+size_t peakMemoryUsage()
+{
+    ifstream file("/proc/self/status");
+
+    string line;
+
+    while (getline(file, line))
+    {
+        if (line.starts_with("VmHWM:"))
+        {
+            try
+            {
+                return stoull(line.substr(6)) * 1024;
+            }
+            catch (const exception& e)
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -21,19 +21,41 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "whitespace.hpp"
 #include "constants.hpp"
 
-Outline::Outline(const string& title, i32 page)
-    : _title(trimWhitespace(title))
+Outline::Outline(string_view title, i32 page, const allocator_type& allocator)
+    : _title(trimWhitespace(title), allocator)
     , _page(page)
+    , _outline(allocator)
 {
 
 }
 
-void Outline::add(const Outline& outline)
+Outline::Outline(const Outline& rhs, const allocator_type& allocator)
+    : _title(rhs._title, allocator)
+    , _page(rhs._page)
+    , _outline(rhs._outline, allocator)
 {
-    _outline.push_back(outline);
+
+}
+
+Outline::Outline(Outline&& rhs, const allocator_type& allocator)
+    : _title(move(rhs._title), allocator)
+    , _page(rhs._page)
+    , _outline(move(rhs._outline), allocator)
+{
+
+}
+
+void Outline::reserve(size_t count)
+{
+    _outline.reserve(count);
+}
+
+void Outline::add(Outline&& outline)
+{
+    _outline.push_back(move(outline));
 }
 
-const string& Outline::title() const
+const pmr::string& Outline::title() const
 {
     return _title;
 }
@@ -43,7 +65,7 @@ i32 Outline::page() const
     return _page;
 }
 
-const vector<Outline>& Outline::outline() const
+const pmr::vector<Outline>& Outline::outline() const
 {
     return _outline;
 }
@@ -72,7 +94,7 @@ i32 Outline::pageIndexAt(i32 selectIndex, i32* y) const
 
 i32 Outline::width() const
 {
-    i32 width = charwiseSize(_title + " (" + to_string(_page + 1) + ")");
+    i32 width = charwiseSize(_title) + charwiseSize(" (" + to_string(_page + 1) + ")");
 
     for (const Outline& outline : _outline)
     {
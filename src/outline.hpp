@@ -23,20 +23,30 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 class Outline
 {
 public:
-    Outline(const string& title, i32 page);
+    typedef pmr::polymorphic_allocator<> allocator_type;
 
-    void add(const Outline& outline);
+    Outline(string_view title, i32 page, const allocator_type& allocator = {});
+    Outline(const Outline& rhs) = default;
+    Outline(Outline&& rhs) = default;
+    Outline(const Outline& rhs, const allocator_type& allocator);
+    Outline(Outline&& rhs, const allocator_type& allocator);
 
-    const string& title() const;
+    Outline& operator=(const Outline& rhs) = default;
+    Outline& operator=(Outline&& rhs) = default;
+
+    void reserve(size_t count);
+    void add(Outline&& outline);
+
+    const pmr::string& title() const;
     i32 page() const;
-    const vector<Outline>& outline() const;
+    const pmr::vector<Outline>& outline() const;
 
     i32 pageIndexAt(i32 selectIndex, i32* y) const;
     i32 width() const;
     i32 height() const;
 
 private:
-    string _title;
+    pmr::string _title;
     i32 _page;
-    vector<Outline> _outline;
+    pmr::vector<Outline> _outline;
 };
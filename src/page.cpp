@@ -19,15 +19,30 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "page.hpp"
 #include "layout.hpp"
 #include "whitespace.hpp"
+#include "constants.hpp"
 
 Page::Page()
+    : arena(make_unique<pmr::monotonic_buffer_resource>(pageArenaInitialSize))
+    , _blocks(arena.get())
+    , _grid(arena.get())
+    , _failed(false)
 {
 
 }
 
-void Page::add(const Block& block)
+pmr::polymorphic_allocator<> Page::allocator() const
 {
-    _blocks.push_back(block);
+    return arena.get();
+}
+
+void Page::reserve(size_t count)
+{
+    _blocks.reserve(count);
+}
+
+void Page::add(Block&& block)
+{
+    _blocks.push_back(move(block));
 }
 
 void Page::adjustBlockOffset(float x, float y)
@@ -38,6 +53,11 @@ void Page::adjustBlockOffset(float x, float y)
     }
 }
 
+void Page::markFailed()
+{
+    _failed = true;
+}
+
 void Page::generateGrid()
 {
     blockOffsets = locate(_blocks);
@@ -54,7 +74,7 @@ void Page::generateGrid()
         height = max(height, y + block.height());
     }
 
-    _grid = vector<vector<string>>(height, vector<string>(width, " "));
+    _grid.assign(height, pmr::vector<pmr::string>(width, " "));
 
     for (size_t i = 0; i < _blocks.size(); i++)
     {
@@ -68,7 +88,7 @@ void Page::generateGrid()
             for (i32 x = 0; x < blockGrid.front().size(); x++)
             {
                 const string& src = blockGrid.at(y).at(x);;
-                string& dst = _grid.at(offsetY + y).at(offsetX + x);
+                pmr::string& dst = _grid.at(offsetY + y).at(offsetX + x);
 
                 if (isWhitespace(src) && !isWhitespace(dst))
                 {
@@ -81,63 +101,93 @@ void Page::generateGrid()
     }
 }
 
-vector<SearchResultLocation> Page::search(const string& search) const
+vector<SearchResultLocation> Page::placeSearchResults(vector<SearchResultLocation>&& results) const
 {
-    vector<SearchResultLocation> results;
+    vector<size_t> order(results.size());
+    iota(order.begin(), order.end(), 0);
 
-    if (search.empty())
-    {
-        return results;
-    }
+    // Results are located a block at a time with one pass over its text
+    stable_sort(order.begin(), order.end(), [&results](size_t a, size_t b) -> bool {
+        return tie(results[a].blockIndex, results[a].characterIndex) < tie(results[b].blockIndex, results[b].characterIndex);
+    });
 
-    for (size_t i = 0; i < _blocks.size(); i++)
+    for (size_t start = 0; start < order.size();)
     {
-        const Block& block = _blocks.at(i);
+        i32 blockIndex = results[order[start]].blockIndex;
 
-        vector<SearchResultLocation> blockResults = block.search(search);
+        vector<i32> characterIndices;
+        size_t end = start;
 
-        for (SearchResultLocation& blockResult : blockResults)
+        while (end < order.size() && results[order[end]].blockIndex == blockIndex)
         {
-            blockResult.blockIndex = i;
-            tie(blockResult.x, blockResult.y) = locateSearchInGrid(blockResult);
+            characterIndices.push_back(results[order[end]].characterIndex);
+            end++;
         }
 
-        results.insert(results.end(), blockResults.begin(), blockResults.end());
+        auto [ blockX, blockY ] = blockOffsets.at(blockIndex);
+
+        vector<tuple<i32, i32>> positions = _blocks.at(blockIndex).locateInGrid(characterIndices);
+
+        for (size_t i = start; i < end; i++)
+        {
+            auto [ x, y ] = positions.at(i - start);
+
+            results[order[i]].x = blockX + x;
+            results[order[i]].y = blockY + y;
+        }
+
+        start = end;
     }
 
-    // Account for the possibility of multiple overlapping searches from different blocks
-    for (size_t i = 0; i < results.size();)
-    {
-        const SearchResultLocation& result = results[i];
+    /*
+     * Account for the possibility of multiple overlapping searches from different blocks. A result is dropped
+     * if it overlaps any result after it, found by sweeping each row in order of position.
+     */
+    sort(order.begin(), order.end(), [&results](size_t a, size_t b) -> bool {
+        return tie(results[a].y, results[a].x) < tie(results[b].y, results[b].x);
+    });
 
-        bool overlap = false;
+    vector<bool> dropped(results.size(), false);
 
-        for (size_t j = 0; j < results.size(); j++)
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const SearchResultLocation& result = results[order[i]];
+
+        for (size_t j = i + 1; j < order.size(); j++)
         {
-            if (i == j)
+            const SearchResultLocation& other = results[order[j]];
+
+            if (other.y != result.y || other.x >= result.x + result.length)
             {
-                continue;
+                break;
             }
 
-            const SearchResultLocation& other = results[j];
-
-            if (result.overlap(other, search))
+            if (result.overlap(other))
             {
-                overlap = true;
-                break;
+                dropped[min(order[i], order[j])] = true;
             }
         }
+    }
 
-        if (overlap)
+    size_t kept = 0;
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        if (dropped[i])
         {
-            results.erase(results.begin() + i);
+            continue;
         }
-        else
+
+        if (kept != i)
         {
-            i++;
+            results[kept] = move(results[i]);
         }
+
+        kept++;
     }
 
+    results.erase(results.begin() + kept, results.end());
+
     sort(results.begin(), results.end());
 
     return results;
@@ -147,7 +197,7 @@ i32 Page::width() const
 {
     i32 width = 0;
 
-    for (const vector<string>& line : grid())
+    for (const pmr::vector<pmr::string>& line : grid())
     {
         width = max<i32>(width, line.size());
     }
@@ -160,12 +210,17 @@ i32 Page::height() const
     return grid().size();
 }
 
-const vector<Block>& Page::blocks() const
+bool Page::failed() const
+{
+    return _failed;
+}
+
+const pmr::vector<Block>& Page::blocks() const
 {
     return _blocks;
 }
 
-const vector<vector<string>>& Page::grid() const
+const pmr::vector<pmr::vector<pmr::string>>& Page::grid() const
 {
     return _grid;
 }
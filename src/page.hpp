@@ -25,23 +25,38 @@ class Page
 {
 public:
     Page();
+    Page(const Page& rhs) = delete;
+    Page(Page&& rhs) = default;
 
-    void add(const Block& block);
+    Page& operator=(const Page& rhs) = delete;
+    Page& operator=(Page&& rhs) = delete;
+
+    // Blocks built with this allocator are moved in without copying their text
+    pmr::polymorphic_allocator<> allocator() const;
+    void reserve(size_t count);
+    void add(Block&& block);
     void adjustBlockOffset(float x, float y);
+    void markFailed();
     void generateGrid();
 
-    vector<SearchResultLocation> search(const string& search) const;
+    // Places block-relative results on the grid, drops overlapping ones and sorts them by position
+    vector<SearchResultLocation> placeSearchResults(vector<SearchResultLocation>&& results) const;
 
     i32 width() const;
     i32 height() const;
-    const vector<Block>& blocks() const;
+    bool failed() const;
+    const pmr::vector<Block>& blocks() const;
 
-    const vector<vector<string>>& grid() const;
+    const pmr::vector<pmr::vector<pmr::string>>& grid() const;
     tuple<i32, i32> locateSearchInGrid(const SearchResultLocation& location) const;
 
 private:
-    vector<Block> _blocks;
+    // Owns the blocks and grid so they can be released in one go, must outlive both
+    unique_ptr<pmr::monotonic_buffer_resource> arena;
+    pmr::vector<Block> _blocks;
     // Stored to help with locating searches
     vector<tuple<i32, i32>> blockOffsets;
-    vector<vector<string>> _grid;
+    pmr::vector<pmr::vector<pmr::string>> _grid;
+    // Set when extraction crashed or timed out on every attempt
+    bool _failed;
 };
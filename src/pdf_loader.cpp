@@ -17,101 +17,242 @@ You should have received a copy of the GNU General Public License
 along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 */
 #include "pdf_loader.hpp"
+#include "constants.hpp"
+#include "charwise.hpp"
+#include "pdf_text_device.hpp"
+#include "extraction_pool.hpp"
 
+#include <unistd.h>
 #include <mupdf/fitz.h>
 
-static vector<Outline> walkOutline(fz_context* ctx, fz_document* fzDocument, const fz_outline* fzOutline)
+static size_t sizeFromEnvironment(const char* name, size_t defaultValue)
 {
-    vector<Outline> outlines;
+    const char* value = getenv(name);
+
+    if (!value)
+    {
+        return defaultValue;
+    }
+
+    try
+    {
+        return stoull(value);
+    }
+    catch (const exception& e)
+    {
+        return defaultValue;
+    }
+}
+
+static size_t storeSize()
+{
+    // Given in mebibytes
+    return max(sizeFromEnvironment(storeSizeVariable, defaultStoreSize / (1024 * 1024)) * 1024 * 1024, minStoreSize);
+}
+
+static pmr::vector<Outline> walkOutline(
+    fz_context* ctx,
+    fz_document* fzDocument,
+    const fz_outline* fzOutline,
+    const pmr::polymorphic_allocator<>& allocator
+)
+{
+    pmr::vector<Outline> outlines(allocator);
+
+    size_t count = 0;
+
+    for (const fz_outline* fzSibling = fzOutline; fzSibling; fzSibling = fzSibling->next)
+    {
+        count++;
+    }
+
+    outlines.reserve(count);
 
     while (fzOutline)
     {
-        Outline outline(
-            fzOutline->title,
+        Outline& outline = outlines.emplace_back(
+            fzOutline->title ? fzOutline->title : "",
             fz_page_number_from_location(ctx, fzDocument, fzOutline->page)
         );
 
-        for (const Outline& subOutline : walkOutline(ctx, fzDocument, fzOutline->down))
+        pmr::vector<Outline> subOutlines = walkOutline(ctx, fzDocument, fzOutline->down, allocator);
+
+        outline.reserve(subOutlines.size());
+
+        for (Outline& subOutline : subOutlines)
         {
-            outline.add(subOutline);
+            outline.add(move(subOutline));
         }
 
-        outlines.push_back(outline);
-
         fzOutline = fzOutline->next;
     }
 
     return outlines;
 }
 
-static string extractCharText(const fz_stext_char* fzChar)
+static void extractLineText(const fz_stext_line* fzLine, string& text)
 {
-    string s;
-    int c = fzChar->c;
+    const fz_stext_char* fzChar = fzLine->first_char;
 
-    if (c <= 0x7f)
+    while (fzChar)
     {
-        s += static_cast<char>(c);
+        appendUTF8(text, fzChar->c);
+
+        fzChar = fzChar->next;
     }
-    else if (c <= 0x7ff)
+}
+
+// Writes into a caller-owned buffer so it can be reused across blocks
+static void extractBlockText(const fz_stext_block* fzBlock, string& text)
+{
+    text.clear();
+
+    const fz_stext_line* fzLine = fzBlock->u.t.first_line;
+
+    while (fzLine)
     {
-        s += 0xc0 | (c >> 6);
-        s += 0x80 | (c & 0x3f);
+        extractLineText(fzLine, text);
+        text += "\n";
+
+        fzLine = fzLine->next;
     }
-    else if (c <= 0xffff)
+}
+
+static bool includeBlock(const fz_stext_block* fzBlock, const fz_rect& pageBounds)
+{
+    return fzBlock->type == FZ_STEXT_BLOCK_TEXT && onPage(fzBlock->bbox, pageBounds);
+}
+
+static void extractStructuredText(fz_context* ctx, fz_page* fzPage, const fz_rect& pageBounds, Page& page, string& text)
+{
+    fz_stext_options options{};
+    options.scale = 1;
+
+    fz_stext_page* fzStextPage = fz_new_stext_page(ctx, pageBounds);
+    fz_device* fzDevice = fz_new_stext_device(ctx, fzStextPage, &options);
+
+    // Images are discarded below, so don't spend time or memory decoding them
+    fz_enable_device_hints(ctx, fzDevice, FZ_DONT_DECODE_IMAGES);
+
+    fz_run_page(ctx, fzPage, fzDevice, fz_identity, NULL);
+    fz_close_device(ctx, fzDevice);
+    fz_drop_device(ctx, fzDevice);
+
+    size_t blockCount = 0;
+
+    for (const fz_stext_block* fzBlock = fzStextPage->first_block; fzBlock; fzBlock = fzBlock->next)
     {
-        s += 0xe0 | (c >> 12);
-        s += 0x80 | ((c >> 6) & 0x3f);
-        s += 0x80 | (c & 0x3f);
+        if (includeBlock(fzBlock, pageBounds))
+        {
+            blockCount++;
+        }
     }
-    else if (c <= 0x10ffff)
+
+    page.reserve(blockCount);
+
+    const fz_stext_block* fzBlock = fzStextPage->first_block;
+
+    while (fzBlock)
     {
-        s += 0xf0 | (c >> 18);
-        s += 0x80 | ((c >> 12) & 0x3f);
-        s += 0x80 | ((c >> 6) & 0x3f);
-        s += 0x80 | (c & 0x3f);
+        if (includeBlock(fzBlock, pageBounds))
+        {
+            extractBlockText(fzBlock, text);
+
+            page.add(Block(
+                fzBlock->bbox.x0,
+                fzBlock->bbox.x1,
+                fzBlock->bbox.y0,
+                fzBlock->bbox.y1,
+                text,
+                page.allocator()
+            ));
+        }
+
+        fzBlock = fzBlock->next;
     }
 
-    return s;
+    fz_drop_stext_page(ctx, fzStextPage);
 }
 
-static string extractLineText(const fz_stext_line* fzLine)
+static bool useStructuredText()
 {
-    string text;
+    const char* value = getenv(extractorVariable);
 
-    const fz_stext_char* fzChar = fzLine->first_char;
+    return value && string(value) == structuredTextExtractor;
+}
 
-    while (fzChar)
+static void extractPage(fz_context* ctx, fz_document* fzDocument, i32 index, bool structuredText, Page& page, string& text)
+{
+    fz_page* fzPage = fz_load_page(ctx, fzDocument, index);
+
+    fz_rect pageBounds = fz_bound_page(ctx, fzPage);
+
+    if (structuredText)
+    {
+        extractStructuredText(ctx, fzPage, pageBounds, page, text);
+    }
+    else
     {
-        text += extractCharText(fzChar);
+        extractPageText(ctx, fzPage, pageBounds, page);
+    }
 
-        fzChar = fzChar->next;
+    float lowestX = numeric_limits<float>::max();
+    float lowestY = numeric_limits<float>::max();
+
+    for (const Block& block : page.blocks())
+    {
+        lowestX = min<float>(lowestX, block.left());
+        lowestY = min<float>(lowestY, block.top());
     }
 
-    return text;
+    page.adjustBlockOffset(lowestX, lowestY);
+
+    fz_drop_page(ctx, fzPage);
 }
 
-static string extractBlockText(const fz_stext_block* fzBlock)
+void runExtractionWorker(const filesystem::path& path)
 {
-    string text;
+    fz_context* ctx = fz_new_context(NULL, NULL, storeSize());
 
-    const fz_stext_line* fzLine = fzBlock->u.t.first_line;
+    fz_register_document_handlers(ctx);
 
-    while (fzLine)
+    fz_document* fzDocument = fz_open_document(ctx, path.string().c_str());
+
+    // Inherited from the process that started the pool
+    bool structuredText = useStructuredText();
+
+    string text;
+    i32 extracted = 0;
+    i32 index;
+
+    while (read(STDIN_FILENO, &index, sizeof(index)) == sizeof(index))
     {
-        text += extractLineText(fzLine) + "\n";
+        Page page;
 
-        fzLine = fzLine->next;
+        extractPage(ctx, fzDocument, index, structuredText, page, text);
+
+        if (!writePage(STDOUT_FILENO, page))
+        {
+            break;
+        }
+
+        extracted++;
+
+        if (extracted % storeScrubInterval == 0)
+        {
+            fz_empty_store(ctx);
+        }
     }
 
-    return text;
+    fz_drop_document(ctx, fzDocument);
+    fz_drop_context(ctx);
 }
 
 Document loadPDF(const filesystem::path& path)
 {
     Document result;
 
-    fz_context* ctx = fz_new_context(NULL, NULL, FZ_STORE_UNLIMITED);
+    fz_context* ctx = fz_new_context(NULL, NULL, storeSize());
 
     fz_register_document_handlers(ctx);
 
@@ -119,63 +260,41 @@ Document loadPDF(const filesystem::path& path)
 
     fz_outline* fzOutline = fz_load_outline(ctx, fzDocument);
 
-    result.setOutline(walkOutline(ctx, fzDocument, fzOutline));
+    result.setOutline(walkOutline(ctx, fzDocument, fzOutline, result.allocator()));
 
     fz_drop_outline(ctx, fzOutline);
 
     int pageCount = fz_count_pages(ctx, fzDocument);
 
-    for (int i = 0; i < pageCount; i++)
-    {
-        fz_page* fzPage = fz_load_page(ctx, fzDocument, i);
+    result.reserve(pageCount);
 
-        Page page;
+    bool structuredText = useStructuredText();
+    size_t workerCount = sizeFromEnvironment(workersVariable, 0);
 
-        fz_rect pageBounds = fz_bound_page(ctx, fzPage);
+    if (workerCount > 0)
+    {
+        ExtractionPool pool(workerCount, { extractionWorkerOption, path.string() });
 
-        fz_stext_options options{};
-        options.scale = 1;
+        pool.extract(result, pageCount);
+    }
+    else
+    {
+        string text;
 
-        fz_stext_page* fzStextPage = fz_new_stext_page_from_page(ctx, fzPage, &options);
+        for (int i = 0; i < pageCount; i++)
+        {
+            Page page;
 
-        const fz_stext_block* fzBlock = fzStextPage->first_block;
+            extractPage(ctx, fzDocument, i, structuredText, page, text);
 
-        float lowestX = numeric_limits<float>::max();
-        float lowestY = numeric_limits<float>::max();
+            result.add(move(page));
 
-        while (fzBlock)
-        {
-            if (fzBlock->type == FZ_STEXT_BLOCK_TEXT && !(
-                fzBlock->bbox.x0 > pageBounds.x1 ||
-                fzBlock->bbox.x1 < pageBounds.x0 ||
-                fzBlock->bbox.y0 > pageBounds.y1 ||
-                fzBlock->bbox.y1 < pageBounds.y0
-            ))
+            // Cached fonts and streams are only reused by nearby pages, periodically drop them to bound peak memory usage
+            if ((i + 1) % storeScrubInterval == 0)
             {
-                Block block(
-                    fzBlock->bbox.x0,
-                    fzBlock->bbox.x1,
-                    fzBlock->bbox.y0,
-                    fzBlock->bbox.y1,
-                    extractBlockText(fzBlock)
-                );
-
-                page.add(block);
-
-                lowestX = min(lowestX, fzBlock->bbox.x0);
-                lowestY = min(lowestY, fzBlock->bbox.y0);
+                fz_empty_store(ctx);
             }
-
-            fzBlock = fzBlock->next;
         }
-
-        page.adjustBlockOffset(lowestX, lowestY);
-
-        fz_drop_stext_page(ctx, fzStextPage);
-
-        result.add(page);
-
-        fz_drop_page(ctx, fzPage);
     }
 
     fz_drop_document(ctx, fzDocument);
@@ -21,3 +21,5 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "document.hpp"
 
 Document loadPDF(const filesystem::path& path);
+// Serves an ExtractionPool from stdin and stdout until it closes the pipe
+void runExtractionWorker(const filesystem::path& path);
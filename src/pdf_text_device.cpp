@@ -0,0 +1,252 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "pdf_text_device.hpp"
+#include "charwise.hpp"
+
+// All distances are relative to the font size, these roughly follow MuPDF's structured text device
+static constexpr float spaceDistance = 0.15;
+static constexpr float maxSpaceDistance = 3;
+static constexpr float backtrackDistance = 0.5;
+static constexpr float lineDistance = 0.5;
+static constexpr float maxLineDistance = 2;
+
+class TextCollector
+{
+public:
+    TextCollector(const fz_rect& pageBounds, Page& page);
+
+    void add(fz_context* ctx, const fz_text* text, fz_matrix ctm);
+    void flush();
+
+private:
+    fz_rect pageBounds;
+    Page& page;
+
+    string text;
+    bool empty;
+    fz_rect bounds;
+    fz_point pen;
+    fz_point direction;
+    float size;
+
+    void addChar(fz_point origin, fz_point direction, float size, float advance, fz_rect bounds, i32 c);
+};
+
+struct TextDevice
+{
+    fz_device super;
+    TextCollector* collector;
+};
+
+TextCollector::TextCollector(const fz_rect& pageBounds, Page& page)
+    : pageBounds(pageBounds)
+    , page(page)
+    , empty(true)
+    , bounds{}
+    , pen{}
+    , direction{ 1, 0 }
+    , size(0)
+{
+
+}
+
+void TextCollector::add(fz_context* ctx, const fz_text* text, fz_matrix ctm)
+{
+    for (const fz_text_span* span = text->head; span; span = span->next)
+    {
+        float ascender = fz_font_ascender(ctx, span->font);
+        float descender = fz_font_descender(ctx, span->font);
+
+        for (int i = 0; i < span->len; i++)
+        {
+            const fz_text_item& item = span->items[i];
+
+            if (item.ucs < 0)
+            {
+                continue;
+            }
+
+            // Extra characters from a ligature glyph share the position of the first
+            if (item.gid < 0)
+            {
+                appendUTF8(this->text, item.ucs);
+                continue;
+            }
+
+            fz_matrix trm = span->trm;
+            trm.e = item.x;
+            trm.f = item.y;
+            trm = fz_concat(trm, ctm);
+
+            float size = fz_matrix_expansion(trm);
+            float advance = fz_advance_glyph(ctx, span->font, item.gid, span->wmode);
+
+            fz_point direction{ trm.a, trm.b };
+            float length = hypot(direction.x, direction.y);
+
+            if (length > 0)
+            {
+                direction.x /= length;
+                direction.y /= length;
+            }
+            else
+            {
+                direction = { 1, 0 };
+            }
+
+            fz_rect bounds = fz_transform_rect({ 0, descender, advance, ascender }, trm);
+
+            addChar({ trm.e, trm.f }, direction, size, advance * size, bounds, item.ucs);
+        }
+    }
+}
+
+void TextCollector::flush()
+{
+    if (!empty && onPage(bounds, pageBounds))
+    {
+        text += "\n";
+
+        page.add(Block(bounds.x0, bounds.x1, bounds.y0, bounds.y1, text, page.allocator()));
+    }
+
+    text.clear();
+    empty = true;
+}
+
+void TextCollector::addChar(fz_point origin, fz_point direction, float size, float advance, fz_rect bounds, i32 c)
+{
+    if (!empty)
+    {
+        float scale = max(size, this->size);
+
+        float dx = origin.x - pen.x;
+        float dy = origin.y - pen.y;
+        float along = dx * this->direction.x + dy * this->direction.y;
+        float across = dy * this->direction.x - dx * this->direction.y;
+
+        bool sameLine =
+            abs(across) < scale * lineDistance &&
+            along > -scale * backtrackDistance &&
+            along < scale * maxSpaceDistance;
+
+        bool nextLine =
+            across > 0 &&
+            across < scale * maxLineDistance &&
+            !(bounds.x0 > this->bounds.x1 + scale || bounds.x1 < this->bounds.x0 - scale);
+
+        if (sameLine)
+        {
+            if (along > scale * spaceDistance && c != ' ' && !text.ends_with(' '))
+            {
+                text += ' ';
+            }
+        }
+        else if (nextLine)
+        {
+            text += "\n";
+        }
+        else
+        {
+            flush();
+        }
+    }
+
+    if (empty)
+    {
+        this->bounds = bounds;
+    }
+    else
+    {
+        this->bounds.x0 = min(this->bounds.x0, bounds.x0);
+        this->bounds.y0 = min(this->bounds.y0, bounds.y0);
+        this->bounds.x1 = max(this->bounds.x1, bounds.x1);
+        this->bounds.y1 = max(this->bounds.y1, bounds.y1);
+    }
+
+    appendUTF8(text, c);
+
+    empty = false;
+    pen = { origin.x + direction.x * advance, origin.y + direction.y * advance };
+    this->direction = direction;
+    this->size = size;
+}
+
+static void fillText(fz_context* ctx, fz_device* dev, const fz_text* text, fz_matrix ctm, fz_colorspace*, const float*, float, fz_color_params)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->add(ctx, text, ctm);
+}
+
+static void strokeText(fz_context* ctx, fz_device* dev, const fz_text* text, const fz_stroke_state*, fz_matrix ctm, fz_colorspace*, const float*, float, fz_color_params)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->add(ctx, text, ctm);
+}
+
+static void clipText(fz_context* ctx, fz_device* dev, const fz_text* text, fz_matrix ctm, fz_rect)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->add(ctx, text, ctm);
+}
+
+static void clipStrokeText(fz_context* ctx, fz_device* dev, const fz_text* text, const fz_stroke_state*, fz_matrix ctm, fz_rect)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->add(ctx, text, ctm);
+}
+
+// Invisible text, typically the OCR layer of a scanned document
+static void ignoreText(fz_context* ctx, fz_device* dev, const fz_text* text, fz_matrix ctm)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->add(ctx, text, ctm);
+}
+
+static void closeDevice(fz_context* ctx, fz_device* dev)
+{
+    reinterpret_cast<TextDevice*>(dev)->collector->flush();
+}
+
+bool onPage(const fz_rect& bounds, const fz_rect& pageBounds)
+{
+    return !(
+        bounds.x0 > pageBounds.x1 ||
+        bounds.x1 < pageBounds.x0 ||
+        bounds.y0 > pageBounds.y1 ||
+        bounds.y1 < pageBounds.y0
+    );
+}
+
+void extractPageText(fz_context* ctx, fz_page* fzPage, const fz_rect& pageBounds, Page& page)
+{
+    TextCollector collector(pageBounds, page);
+
+    TextDevice* device = reinterpret_cast<TextDevice*>(fz_new_device_of_size(ctx, sizeof(TextDevice)));
+
+    device->super.fill_text = fillText;
+    device->super.stroke_text = strokeText;
+    device->super.clip_text = clipText;
+    device->super.clip_stroke_text = clipStrokeText;
+    device->super.ignore_text = ignoreText;
+    device->super.close_device = closeDevice;
+    device->collector = &collector;
+
+    // Only text is collected, so don't spend time or memory decoding images
+    fz_enable_device_hints(ctx, &device->super, FZ_DONT_DECODE_IMAGES);
+
+    fz_run_page(ctx, fzPage, &device->super, fz_identity, NULL);
+    fz_close_device(ctx, &device->super);
+    fz_drop_device(ctx, &device->super);
+}
@@ -0,0 +1,160 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "phrase_pattern.hpp"
+
+static bool isBreak(char c)
+{
+    return c == ' ' || c == '\n' || c == '\0' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Offset after white space starting at offset, if it runs on to the end of a line, block or page
+static size_t lineBreakEnd(string_view text, size_t offset)
+{
+    bool lineBreak = false;
+
+    while (offset < text.size() && isBreak(text[offset]))
+    {
+        lineBreak = lineBreak || text[offset] == '\n' || text[offset] == '\0';
+        offset++;
+    }
+
+    return lineBreak ? offset : string::npos;
+}
+
+PhrasePattern::PhrasePattern(string_view pattern)
+{
+    for (char c : pattern)
+    {
+        if (!isBreak(c))
+        {
+            this->pattern += c;
+        }
+        else if (!this->pattern.empty() && this->pattern.back() != ' ')
+        {
+            this->pattern += ' ';
+        }
+    }
+
+    if (!this->pattern.empty() && this->pattern.back() == ' ')
+    {
+        this->pattern.pop_back();
+    }
+}
+
+bool PhrasePattern::empty() const
+{
+    return pattern.empty();
+}
+
+vector<TextSpan> PhrasePattern::find(string_view text, size_t start, size_t end) const
+{
+    vector<TextSpan> matches;
+
+    if (pattern.empty())
+    {
+        return matches;
+    }
+
+    size_t offset = start;
+
+    while (offset < end)
+    {
+        const char* candidate = static_cast<const char*>(memchr(text.data() + offset, pattern.front(), end - offset));
+
+        if (!candidate)
+        {
+            break;
+        }
+
+        offset = candidate - text.data();
+
+        size_t matchEnd = matchAt(text, offset);
+
+        if (matchEnd == string::npos)
+        {
+            offset++;
+            continue;
+        }
+
+        matches.push_back({ offset, matchEnd - offset });
+
+        offset = matchEnd;
+    }
+
+    return matches;
+}
+
+bool PhrasePattern::matches(string_view text) const
+{
+    return !pattern.empty() && matchAt(text, 0) == text.size();
+}
+
+size_t PhrasePattern::matchAt(string_view text, size_t offset) const
+{
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        char c = pattern[i];
+
+        if (c == ' ')
+        {
+            if (offset >= text.size() || !isBreak(text[offset]))
+            {
+                return string::npos;
+            }
+
+            while (offset < text.size() && isBreak(text[offset]))
+            {
+                offset++;
+            }
+
+            continue;
+        }
+
+        // A word hyphenated over a line break matches the word without the hyphen
+        if (c != '-' && offset < text.size() && text[offset] == '-')
+        {
+            size_t next = lineBreakEnd(text, offset + 1);
+
+            if (next != string::npos)
+            {
+                offset = next;
+            }
+        }
+
+        if (offset >= text.size() || text[offset] != c)
+        {
+            return string::npos;
+        }
+
+        offset++;
+
+        // And one with the hyphen the line break comes after
+        if (c == '-' && i + 1 < pattern.size())
+        {
+            size_t next = lineBreakEnd(text, offset);
+
+            if (next != string::npos)
+            {
+                offset = next;
+            }
+        }
+    }
+
+    return offset;
+}
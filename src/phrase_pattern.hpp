@@ -0,0 +1,46 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+
+/*
+ * Words matched in order across line, block and page breaks. Any run of white space or breaks between
+ * them matches any other, and a word may be split by a hyphen at the end of a line.
+ */
+class PhrasePattern
+{
+public:
+    PhrasePattern(string_view pattern);
+
+    bool empty() const;
+
+    // Non-overlapping matches starting in text between start and end, which may carry on past end
+    vector<TextSpan> find(string_view text, size_t start, size_t end) const;
+    // Whether the whole of text matches
+    bool matches(string_view text) const;
+
+private:
+    // Words separated by single spaces
+    string pattern;
+
+    // Offset just past a match at offset, or npos if there is none
+    size_t matchAt(string_view text, size_t offset) const;
+};
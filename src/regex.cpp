@@ -0,0 +1,1205 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "regex.hpp"
+#include "constants.hpp"
+#include "charwise.hpp"
+
+// Symbols past the bytes mark the end of the text, followed by a character of the given context
+static constexpr i32 endSymbol = 256;
+static constexpr i32 symbolCount = endSymbol + 3;
+
+static constexpr u8 lineContext = 0;
+static constexpr u8 wordContext = 1;
+static constexpr u8 otherContext = 2;
+
+static constexpr i32 maxCodepoint = 0x10ffff;
+
+static u8 contextOf(char c)
+{
+    u8 byte = c;
+
+    if (byte == '\n' || byte == '\0')
+    {
+        return lineContext;
+    }
+    else if ((byte >= '0' && byte <= '9') || (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z') || byte == '_' || byte >= 0x80)
+    {
+        return wordContext;
+    }
+    else
+    {
+        return otherContext;
+    }
+}
+
+typedef vector<pair<i32, i32>> CodepointRanges;
+typedef vector<pair<u8, u8>> ByteSequence;
+
+static void sortRanges(CodepointRanges& ranges)
+{
+    sort(ranges.begin(), ranges.end());
+
+    CodepointRanges merged;
+
+    for (const auto& [ low, high ] : ranges)
+    {
+        if (!merged.empty() && low <= merged.back().second + 1)
+        {
+            merged.back().second = max(merged.back().second, high);
+        }
+        else
+        {
+            merged.push_back({ low, high });
+        }
+    }
+
+    ranges = move(merged);
+}
+
+static CodepointRanges complementRanges(const CodepointRanges& ranges)
+{
+    CodepointRanges complement;
+
+    // Null bytes separate blocks and are never matched
+    i32 next = 1;
+
+    for (const auto& [ low, high ] : ranges)
+    {
+        if (low > next)
+        {
+            complement.push_back({ next, low - 1 });
+        }
+
+        next = max(next, high + 1);
+    }
+
+    if (next <= maxCodepoint)
+    {
+        complement.push_back({ next, maxCodepoint });
+    }
+
+    return complement;
+}
+
+// Splits a code point range into runs of byte ranges that together match exactly its UTF-8 encodings
+static void splitUTF8Range(i32 low, i32 high, vector<ByteSequence>* sequences)
+{
+    if (low > high)
+    {
+        return;
+    }
+
+    // Surrogates have no encoding
+    if (low <= 0xdfff && high >= 0xd800)
+    {
+        splitUTF8Range(low, 0xd7ff, sequences);
+        splitUTF8Range(0xe000, high, sequences);
+        return;
+    }
+
+    for (i32 limit : { 0x7f, 0x7ff, 0xffff })
+    {
+        if (low <= limit && high > limit)
+        {
+            splitUTF8Range(low, limit, sequences);
+            splitUTF8Range(limit + 1, high, sequences);
+            return;
+        }
+    }
+
+    if (high <= 0x7f)
+    {
+        sequences->push_back({ { low, high } });
+        return;
+    }
+
+    for (i32 i = 1; i < 4; i++)
+    {
+        i32 mask = (1 << (6 * i)) - 1;
+
+        if ((low & ~mask) != (high & ~mask))
+        {
+            if ((low & mask) != 0)
+            {
+                splitUTF8Range(low, low | mask, sequences);
+                splitUTF8Range((low | mask) + 1, high, sequences);
+                return;
+            }
+
+            if ((high & mask) != mask)
+            {
+                splitUTF8Range(low, (high & ~mask) - 1, sequences);
+                splitUTF8Range(high & ~mask, high, sequences);
+                return;
+            }
+        }
+    }
+
+    string lowBytes;
+    string highBytes;
+
+    appendUTF8(lowBytes, low);
+    appendUTF8(highBytes, high);
+
+    ByteSequence sequence;
+
+    for (size_t i = 0; i < lowBytes.size(); i++)
+    {
+        sequence.push_back({ lowBytes[i], highBytes[i] });
+    }
+
+    sequences->push_back(sequence);
+}
+
+struct Regex::Node
+{
+    enum class Type : u8
+    {
+        // Alternative byte sequences, each one a character or the normalized form of a literal
+        Set,
+        Concatenation,
+        Alternation,
+        Repetition,
+        Check
+    };
+
+    Type type;
+    vector<ByteSequence> sequences;
+    vector<Node> children;
+    i32 min;
+    i32 max;
+    Assertion assertion;
+};
+
+class Regex::Parser
+{
+public:
+    Parser(string_view pattern, bool caseFold)
+        : pattern(pattern)
+        , offset(0)
+        , caseFold(caseFold)
+        , hasUpperCase(false)
+    {
+
+    }
+
+    optional<Node> parse()
+    {
+        optional<Node> node = alternation();
+
+        if (offset != pattern.size())
+        {
+            return {};
+        }
+
+        return node;
+    }
+
+    bool foundUpperCase() const
+    {
+        return hasUpperCase;
+    }
+
+private:
+    string_view pattern;
+    size_t offset;
+    bool caseFold;
+    bool hasUpperCase;
+
+    bool atEnd() const
+    {
+        return offset >= pattern.size();
+    }
+
+    char peek() const
+    {
+        return pattern[offset];
+    }
+
+    i32 nextCharacter()
+    {
+        size_t size;
+        i32 c = decodeUTF8(pattern, offset, &size);
+
+        offset += size;
+
+        return c;
+    }
+
+    optional<Node> alternation()
+    {
+        Node node{ Node::Type::Alternation };
+
+        while (true)
+        {
+            optional<Node> child = concatenation();
+
+            if (!child)
+            {
+                return {};
+            }
+
+            node.children.push_back(move(*child));
+
+            if (atEnd() || peek() != '|')
+            {
+                break;
+            }
+
+            offset++;
+        }
+
+        if (node.children.size() == 1)
+        {
+            return move(node.children.front());
+        }
+
+        return node;
+    }
+
+    optional<Node> concatenation()
+    {
+        Node node{ Node::Type::Concatenation };
+
+        while (!atEnd() && peek() != '|' && peek() != ')')
+        {
+            optional<Node> child = repetition();
+
+            if (!child)
+            {
+                return {};
+            }
+
+            node.children.push_back(move(*child));
+        }
+
+        return node;
+    }
+
+    optional<Node> repetition()
+    {
+        optional<Node> node = atom();
+
+        if (!node)
+        {
+            return {};
+        }
+
+        while (!atEnd())
+        {
+            i32 min;
+            i32 max;
+
+            if (peek() == '*')
+            {
+                min = 0;
+                max = -1;
+                offset++;
+            }
+            else if (peek() == '+')
+            {
+                min = 1;
+                max = -1;
+                offset++;
+            }
+            else if (peek() == '?')
+            {
+                min = 0;
+                max = 1;
+                offset++;
+            }
+            else if (peek() == '{' && bounds(&min, &max))
+            {
+                if (max >= 0 && min > max)
+                {
+                    return {};
+                }
+            }
+            else
+            {
+                break;
+            }
+
+            // Lazy quantifiers mean nothing to a DFA, which always finds the longest match
+            if (!atEnd() && peek() == '?')
+            {
+                offset++;
+            }
+
+            Node repeated{ Node::Type::Repetition };
+            repeated.children.push_back(move(*node));
+            repeated.min = min;
+            repeated.max = max;
+
+            node = move(repeated);
+        }
+
+        return node;
+    }
+
+    // Reads {n}, {n,} or {n,m}, leaving the brace to be read as a literal if it is none of those
+    bool bounds(i32* min, i32* max)
+    {
+        size_t start = offset;
+
+        offset++;
+
+        auto number = [this]() -> i32 {
+            i32 value = -1;
+
+            while (!atEnd() && peek() >= '0' && peek() <= '9')
+            {
+                value = (value < 0 ? 0 : value * 10) + (peek() - '0');
+
+                if (value > maxRegexRepetition)
+                {
+                    return -2;
+                }
+
+                offset++;
+            }
+
+            return value;
+        };
+
+        *min = number();
+        *max = *min;
+
+        if (!atEnd() && peek() == ',')
+        {
+            offset++;
+            // No upper bound leaves max at -1 for unbounded
+            *max = number();
+        }
+
+        if (*min < 0 || *max < -1 || atEnd() || peek() != '}')
+        {
+            offset = start;
+            return false;
+        }
+
+        offset++;
+
+        return true;
+    }
+
+    optional<Node> atom()
+    {
+        if (atEnd())
+        {
+            return {};
+        }
+
+        char c = peek();
+
+        if (c == '(')
+        {
+            offset++;
+
+            if (pattern.substr(offset, 2) == "?:")
+            {
+                offset += 2;
+            }
+
+            optional<Node> node = alternation();
+
+            if (!node || atEnd() || peek() != ')')
+            {
+                return {};
+            }
+
+            offset++;
+
+            return node;
+        }
+        else if (c == '[')
+        {
+            offset++;
+
+            return characterClass();
+        }
+        else if (c == '.')
+        {
+            offset++;
+
+            // Any character but a line break
+            return set({ { 1, '\n' - 1 }, { '\n' + 1, maxCodepoint } }, false);
+        }
+        else if (c == '^' || c == '$')
+        {
+            offset++;
+
+            Node node{ Node::Type::Check };
+            node.assertion = c == '^' ? Assertion::LineStart : Assertion::LineEnd;
+
+            return node;
+        }
+        else if (c == '*' || c == '+' || c == '?' || c == ')')
+        {
+            return {};
+        }
+        else if (c == '\\')
+        {
+            offset++;
+
+            if (atEnd())
+            {
+                return {};
+            }
+
+            char escape = peek();
+
+            if (escape == 'b' || escape == 'B')
+            {
+                offset++;
+
+                Node node{ Node::Type::Check };
+                node.assertion = escape == 'b' ? Assertion::WordBoundary : Assertion::NotWordBoundary;
+
+                return node;
+            }
+
+            CodepointRanges ranges;
+            bool negated;
+
+            if (classEscape(escape, &ranges, &negated))
+            {
+                offset++;
+
+                return set(ranges, negated);
+            }
+
+            i32 literal = escapedCharacter();
+
+            if (literal < 0)
+            {
+                return {};
+            }
+
+            return literalNode(literal);
+        }
+        else
+        {
+            i32 literal = nextCharacter();
+
+            if (literal < 0)
+            {
+                return {};
+            }
+
+            return literalNode(literal);
+        }
+    }
+
+    // Reads the character after a backslash, or -1 if it is not one that can be escaped
+    i32 escapedCharacter()
+    {
+        char c = peek();
+
+        switch (c)
+        {
+        case 'n' :
+            offset++;
+            return '\n';
+        case 't' :
+            offset++;
+            return '\t';
+        case 'r' :
+            offset++;
+            return '\r';
+        case 'f' :
+            offset++;
+            return '\f';
+        case 'v' :
+            offset++;
+            return '\v';
+        }
+
+        // Letters and digits are reserved for escapes with meanings, such as back-references which are not supported
+        if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+        {
+            return -1;
+        }
+
+        return nextCharacter();
+    }
+
+    static bool classEscape(char c, CodepointRanges* ranges, bool* negated)
+    {
+        switch (c)
+        {
+        case 'd' :
+        case 'D' :
+            *ranges = { { '0', '9' } };
+            break;
+        case 'w' :
+        case 'W' :
+            *ranges = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } };
+            break;
+        case 's' :
+        case 'S' :
+            *ranges = { { '\t', '\r' }, { ' ', ' ' } };
+            break;
+        default :
+            return false;
+        }
+
+        *negated = c >= 'A' && c <= 'Z';
+
+        return true;
+    }
+
+    optional<Node> characterClass()
+    {
+        bool negated = false;
+
+        if (!atEnd() && peek() == '^')
+        {
+            negated = true;
+            offset++;
+        }
+
+        CodepointRanges ranges;
+        bool first = true;
+
+        while (true)
+        {
+            if (atEnd())
+            {
+                return {};
+            }
+
+            if (peek() == ']' && !first)
+            {
+                offset++;
+                break;
+            }
+
+            first = false;
+
+            i32 low;
+
+            if (peek() == '\\')
+            {
+                offset++;
+
+                if (atEnd())
+                {
+                    return {};
+                }
+
+                CodepointRanges escaped;
+                bool escapedNegated;
+
+                if (classEscape(peek(), &escaped, &escapedNegated))
+                {
+                    offset++;
+
+                    if (escapedNegated)
+                    {
+                        escaped = complementRanges(escaped);
+                    }
+
+                    ranges.insert(ranges.end(), escaped.begin(), escaped.end());
+                    continue;
+                }
+
+                low = escapedCharacter();
+            }
+            else
+            {
+                low = nextCharacter();
+            }
+
+            if (low < 0)
+            {
+                return {};
+            }
+
+            i32 high = low;
+
+            if (pattern.substr(offset, 1) == "-" && pattern.substr(offset + 1, 1) != "]" && offset + 1 < pattern.size())
+            {
+                offset++;
+
+                if (peek() == '\\')
+                {
+                    offset++;
+
+                    if (atEnd())
+                    {
+                        return {};
+                    }
+
+                    high = escapedCharacter();
+                }
+                else
+                {
+                    high = nextCharacter();
+                }
+
+                if (high < low)
+                {
+                    return {};
+                }
+            }
+
+            if (isUpperCase(low) || isUpperCase(high))
+            {
+                hasUpperCase = true;
+            }
+
+            ranges.push_back({ low, high });
+        }
+
+        return set(ranges, negated);
+    }
+
+    Node literalNode(i32 c)
+    {
+        if (isUpperCase(c))
+        {
+            hasUpperCase = true;
+        }
+
+        string literal;
+        appendUTF8(literal, c);
+
+        Node node{ Node::Type::Set };
+
+        ByteSequence sequence;
+
+        for (char byte : normalizeForSearch(literal, caseFold))
+        {
+            sequence.push_back({ byte, byte });
+        }
+
+        // Characters normalized away, like soft hyphens, match nothing at all
+        if (sequence.empty())
+        {
+            return Node{ Node::Type::Concatenation };
+        }
+
+        node.sequences.push_back(sequence);
+
+        return node;
+    }
+
+    // Search text only holds normalized characters, so a class matches what its members normalize to
+    Node set(CodepointRanges ranges, bool negated)
+    {
+        size_t count = ranges.size();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto [ low, high ] = ranges.at(i);
+
+            if (high - low > maxNormalizedClassRange)
+            {
+                continue;
+            }
+
+            for (i32 c = low; c <= high; c++)
+            {
+                i32 normalized = normalizeCharacter(c, caseFold);
+
+                if (normalized > 0 && normalized != c)
+                {
+                    ranges.push_back({ normalized, normalized });
+                }
+            }
+        }
+
+        sortRanges(ranges);
+
+        if (negated)
+        {
+            ranges = complementRanges(ranges);
+        }
+
+        Node node{ Node::Type::Set };
+
+        for (const auto& [ low, high ] : ranges)
+        {
+            // Null bytes separate blocks and are never matched
+            splitUTF8Range(max(low, 1), high, &node.sequences);
+        }
+
+        return node;
+    }
+};
+
+class Regex::DFA
+{
+public:
+    DFA(const vector<Instruction>& program, i32 start, bool unanchored)
+        : program(program)
+        , start(start)
+        , unanchored(unanchored)
+        , marks(program.size(), 0)
+        , generation(0)
+    {
+
+    }
+
+    i32 initial(u8 context)
+    {
+        return intern(unanchored ? vector<i32>() : vector<i32>({ start }), context);
+    }
+
+    bool dead(i32 state) const
+    {
+        return !unanchored && kernels.at(state).empty();
+    }
+
+    // Moves across a byte or end symbol, reporting whether a match ended just before it
+    i32 step(i32 state, i32 symbol, bool* matchBefore)
+    {
+        i32 cached = transitions.at(state * symbolCount + symbol);
+
+        if (cached >= 0)
+        {
+            *matchBefore = cached & 1;
+            return cached >> 1;
+        }
+
+        u8 after = symbol >= endSymbol ? symbol - endSymbol : contextOf(symbol);
+
+        vector<i32> next;
+        *matchBefore = false;
+
+        for (i32 pc : closure(kernels.at(state), contexts.at(state), after))
+        {
+            const Instruction& instruction = program.at(pc);
+
+            if (instruction.type == InstructionType::Match)
+            {
+                *matchBefore = true;
+            }
+            else if (instruction.type == InstructionType::Byte && symbol < endSymbol && symbol >= instruction.low && symbol <= instruction.high)
+            {
+                next.push_back(instruction.next);
+            }
+        }
+
+        sort(next.begin(), next.end());
+        next.erase(unique(next.begin(), next.end()), next.end());
+
+        // Start over rather than grow without bound on pathological expressions
+        if (kernels.size() >= maxRegexStates)
+        {
+            vector<i32> kernel = kernels.at(state);
+            u8 context = contexts.at(state);
+
+            stateIDs.clear();
+            kernels.clear();
+            contexts.clear();
+            transitions.clear();
+
+            state = intern(move(kernel), context);
+        }
+
+        i32 target = intern(move(next), after);
+
+        transitions.at(state * symbolCount + symbol) = (target << 1) | (*matchBefore ? 1 : 0);
+
+        return target;
+    }
+
+private:
+    const vector<Instruction>& program;
+    i32 start;
+    bool unanchored;
+
+    map<pair<vector<i32>, u8>, i32> stateIDs;
+    vector<vector<i32>> kernels;
+    vector<u8> contexts;
+    vector<i32> transitions;
+
+    vector<u32> marks;
+    u32 generation;
+
+    i32 intern(vector<i32>&& kernel, u8 context)
+    {
+        auto it = stateIDs.find({ kernel, context });
+
+        if (it != stateIDs.end())
+        {
+            return it->second;
+        }
+
+        i32 state = kernels.size();
+
+        stateIDs.insert({ { kernel, context }, state });
+        kernels.push_back(move(kernel));
+        contexts.push_back(context);
+        transitions.resize(transitions.size() + symbolCount, -1);
+
+        return state;
+    }
+
+    static bool holds(Assertion assertion, u8 before, u8 after)
+    {
+        switch (assertion)
+        {
+        case Assertion::WordBoundary :
+            return (before == wordContext) != (after == wordContext);
+        case Assertion::NotWordBoundary :
+            return (before == wordContext) == (after == wordContext);
+        case Assertion::LineStart :
+            return before == lineContext;
+        case Assertion::LineEnd :
+            return after == lineContext;
+        }
+
+        return false;
+    }
+
+    // Every byte and match instruction reachable without consuming input
+    vector<i32> closure(const vector<i32>& kernel, u8 before, u8 after)
+    {
+        generation++;
+
+        vector<i32> reached;
+        vector<i32> stack(kernel.rbegin(), kernel.rend());
+
+        if (unanchored)
+        {
+            stack.push_back(start);
+        }
+
+        while (!stack.empty())
+        {
+            i32 pc = stack.back();
+            stack.pop_back();
+
+            if (marks.at(pc) == generation)
+            {
+                continue;
+            }
+
+            marks.at(pc) = generation;
+
+            const Instruction& instruction = program.at(pc);
+
+            switch (instruction.type)
+            {
+            case InstructionType::Byte :
+            case InstructionType::Match :
+                reached.push_back(pc);
+                break;
+            case InstructionType::Split :
+                stack.push_back(instruction.alternative);
+                stack.push_back(instruction.next);
+                break;
+            case InstructionType::Assert :
+                if (holds(instruction.assertion, before, after))
+                {
+                    stack.push_back(instruction.next);
+                }
+                break;
+            }
+        }
+
+        return reached;
+    }
+};
+
+Regex::Regex(string_view pattern, bool caseFold)
+    : _valid(false)
+    , _hasUpperCase(false)
+    , forwardStart(0)
+    , reverseStart(0)
+{
+    Parser parser(pattern, caseFold);
+
+    optional<Node> root = parser.parse();
+
+    if (!root)
+    {
+        return;
+    }
+
+    _hasUpperCase = parser.foundUpperCase();
+
+    forward.push_back({ InstructionType::Match });
+    forwardStart = compile(*root, 0, false, &forward);
+
+    reverse.push_back({ InstructionType::Match });
+    reverseStart = compile(*root, 0, true, &reverse);
+
+    _valid = forwardStart >= 0 && reverseStart >= 0;
+
+    if (_valid)
+    {
+        matchDFA = make_unique<DFA>(forward, forwardStart, false);
+    }
+}
+
+Regex::~Regex()
+{
+
+}
+
+bool Regex::valid() const
+{
+    return _valid;
+}
+
+bool Regex::hasUpperCase() const
+{
+    return _hasUpperCase;
+}
+
+vector<TextSpan> Regex::find(string_view text, size_t start, size_t end) const
+{
+    vector<TextSpan> matches;
+
+    if (!_valid || start >= end)
+    {
+        return matches;
+    }
+
+    // Every position a match starts at, from one backward pass of the reversed expression
+    vector<bool> starts(end - start + 1, false);
+
+    DFA backward(reverse, reverseStart, true);
+
+    i32 state = backward.initial(lineContext);
+
+    for (size_t i = end; ; i--)
+    {
+        i32 symbol = i > start ? static_cast<u8>(text[i - 1]) : endSymbol + lineContext;
+
+        bool matchBefore;
+        state = backward.step(state, symbol, &matchBefore);
+
+        starts[i - start] = matchBefore;
+
+        if (i == start)
+        {
+            break;
+        }
+    }
+
+    // Then the longest match from each start that follows the previous match
+    DFA forwards(forward, forwardStart, false);
+
+    size_t position = start;
+
+    while (position < end)
+    {
+        size_t matchStart = std::find(starts.begin() + (position - start), starts.end(), true) - starts.begin() + start;
+
+        if (matchStart >= end)
+        {
+            break;
+        }
+
+        state = forwards.initial(matchStart > start ? contextOf(text[matchStart - 1]) : lineContext);
+
+        size_t matchEnd = matchStart;
+
+        for (size_t i = matchStart; ; i++)
+        {
+            i32 symbol = i < end ? static_cast<u8>(text[i]) : endSymbol + lineContext;
+
+            bool matchBefore;
+            state = forwards.step(state, symbol, &matchBefore);
+
+            if (matchBefore)
+            {
+                matchEnd = i;
+            }
+
+            if (i == end || forwards.dead(state))
+            {
+                break;
+            }
+        }
+
+        if (matchEnd == matchStart)
+        {
+            position = matchStart + 1;
+            continue;
+        }
+
+        matches.push_back({ matchStart, matchEnd - matchStart });
+
+        position = matchEnd;
+    }
+
+    return matches;
+}
+
+bool Regex::matches(string_view text, char before, char after) const
+{
+    if (!_valid)
+    {
+        return false;
+    }
+
+    lock_guard<mutex> lock(matchLock);
+
+    i32 state = matchDFA->initial(contextOf(before));
+
+    for (char c : text)
+    {
+        bool matchBefore;
+        state = matchDFA->step(state, static_cast<u8>(c), &matchBefore);
+
+        if (matchDFA->dead(state))
+        {
+            return false;
+        }
+    }
+
+    bool matchBefore;
+    matchDFA->step(state, endSymbol + contextOf(after), &matchBefore);
+
+    return matchBefore;
+}
+
+i32 Regex::compile(const Node& node, i32 next, bool reversed, vector<Instruction>* program) const
+{
+    if (next < 0 || program->size() > maxRegexInstructions)
+    {
+        return -1;
+    }
+
+    auto emit = [program](const Instruction& instruction) -> i32 {
+        program->push_back(instruction);
+
+        return program->size() - 1;
+    };
+
+    switch (node.type)
+    {
+    case Node::Type::Set :
+    {
+        i32 start = -1;
+
+        for (const ByteSequence& sequence : node.sequences)
+        {
+            i32 pc = next;
+
+            // Programs are built back to front, and the reversed one reads each sequence backwards
+            for (size_t i = 0; i < sequence.size(); i++)
+            {
+                const auto& [ low, high ] = reversed ? sequence.at(i) : sequence.at(sequence.size() - 1 - i);
+
+                pc = emit({ InstructionType::Byte, low, high, Assertion::WordBoundary, pc, -1 });
+            }
+
+            start = start < 0 ? pc : emit({ InstructionType::Split, 0, 0, Assertion::WordBoundary, pc, start });
+        }
+
+        // An empty class can never match, a byte range with nothing in it does the same
+        return start >= 0 ? start : emit({ InstructionType::Byte, 1, 0, Assertion::WordBoundary, next, -1 });
+    }
+    case Node::Type::Concatenation :
+    {
+        i32 pc = next;
+
+        for (size_t i = 0; i < node.children.size(); i++)
+        {
+            pc = compile(node.children.at(reversed ? i : node.children.size() - 1 - i), pc, reversed, program);
+        }
+
+        return pc;
+    }
+    case Node::Type::Alternation :
+    {
+        i32 start = -1;
+
+        for (const Node& child : node.children)
+        {
+            i32 pc = compile(child, next, reversed, program);
+
+            if (pc < 0)
+            {
+                return -1;
+            }
+
+            start = start < 0 ? pc : emit({ InstructionType::Split, 0, 0, Assertion::WordBoundary, pc, start });
+        }
+
+        return start;
+    }
+    case Node::Type::Repetition :
+    {
+        const Node& child = node.children.front();
+
+        i32 pc = next;
+
+        if (node.max < 0)
+        {
+            i32 loop = emit({ InstructionType::Split, 0, 0, Assertion::WordBoundary, -1, next });
+            i32 body = compile(child, loop, reversed, program);
+
+            if (body < 0)
+            {
+                return -1;
+            }
+
+            program->at(loop).next = body;
+            pc = loop;
+        }
+        else
+        {
+            for (i32 i = node.min; i < node.max; i++)
+            {
+                i32 body = compile(child, pc, reversed, program);
+
+                if (body < 0)
+                {
+                    return -1;
+                }
+
+                pc = emit({ InstructionType::Split, 0, 0, Assertion::WordBoundary, body, next });
+            }
+        }
+
+        for (i32 i = 0; i < node.min; i++)
+        {
+            pc = compile(child, pc, reversed, program);
+        }
+
+        return pc;
+    }
+    case Node::Type::Check :
+    {
+        Assertion assertion = node.assertion;
+
+        // Read backwards the start of a line comes last
+        if (reversed && assertion == Assertion::LineStart)
+        {
+            assertion = Assertion::LineEnd;
+        }
+        else if (reversed && assertion == Assertion::LineEnd)
+        {
+            assertion = Assertion::LineStart;
+        }
+
+        return emit({ InstructionType::Assert, 0, 0, assertion, next, -1 });
+    }
+    }
+
+    return -1;
+}
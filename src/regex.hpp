@@ -0,0 +1,94 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+
+/*
+ * A regular expression matched by lazily built DFAs with no backtracking. Supports literals, ., [classes],
+ * \d \w \s and their negations, groups, |, * + ? {n,m} and the assertions ^ $ \b \B. Matches never cross
+ * null bytes. Match starts are found in one backward pass, but the longest match from each start is found
+ * by scanning forward until the expression can't match any further, so something like a|a*b can take time
+ * quadratic in the text.
+ */
+class Regex
+{
+public:
+    // Literals and classes are normalized like search text, and case-folded too if asked
+    Regex(string_view pattern, bool caseFold);
+    Regex(const Regex& rhs) = delete;
+    Regex(Regex&& rhs) = delete;
+    ~Regex();
+
+    Regex& operator=(const Regex& rhs) = delete;
+    Regex& operator=(Regex&& rhs) = delete;
+
+    bool valid() const;
+    bool hasUpperCase() const;
+
+    // Leftmost-longest non-empty matches in text between start and end, which are treated as line breaks
+    vector<TextSpan> find(string_view text, size_t start, size_t end) const;
+    // Whether the whole of text matches, given the characters either side of it
+    bool matches(string_view text, char before, char after) const;
+
+private:
+    enum class InstructionType : u8
+    {
+        Byte,
+        Split,
+        Assert,
+        Match
+    };
+
+    enum class Assertion : u8
+    {
+        WordBoundary,
+        NotWordBoundary,
+        LineStart,
+        LineEnd
+    };
+
+    struct Instruction
+    {
+        InstructionType type;
+        u8 low;
+        u8 high;
+        Assertion assertion;
+        i32 next;
+        i32 alternative;
+    };
+
+    struct Node;
+    class Parser;
+    class DFA;
+
+    bool _valid;
+    bool _hasUpperCase;
+    // The reversed program finds where matches start in one backward pass
+    vector<Instruction> forward;
+    i32 forwardStart;
+    vector<Instruction> reverse;
+    i32 reverseStart;
+    // Kept across calls to matches so the states it builds are reused, which page tasks make from several threads
+    mutable mutex matchLock;
+    mutable unique_ptr<DFA> matchDFA;
+
+    i32 compile(const Node& node, i32 next, bool reversed, vector<Instruction>* program) const;
+};
@@ -0,0 +1,85 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "search_cache.hpp"
+#include "constants.hpp"
+
+SearchCache::SearchCache()
+    : size(0)
+{
+
+}
+
+const SearchResults* SearchCache::find(const string& documentName, const string& search, CaseMode caseMode)
+{
+    auto it = index.find({ documentName, search, caseMode });
+
+    if (it == index.end())
+    {
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+
+    return &it->second->results;
+}
+
+void SearchCache::insert(const string& documentName, const string& search, CaseMode caseMode, const SearchResults& results)
+{
+    Key key = { documentName, search, caseMode };
+
+    auto it = index.find(key);
+
+    if (it != index.end())
+    {
+        size -= it->second->size;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    Entry entry = { key, results, results.memorySize() };
+
+    size += entry.size;
+    entries.push_front(move(entry));
+    index.insert({ key, entries.begin() });
+
+    evict();
+}
+
+void SearchCache::erase(const string& documentName)
+{
+    // Keys sort by document first, so its entries are next to each other
+    auto it = index.lower_bound({ documentName, "", CaseMode::Sensitive });
+
+    while (it != index.end() && get<0>(it->first) == documentName)
+    {
+        size -= it->second->size;
+        entries.erase(it->second);
+        it = index.erase(it);
+    }
+}
+
+void SearchCache::evict()
+{
+    while (!entries.empty() && (entries.size() > searchCacheSize || size > searchCacheByteLimit))
+    {
+        size -= entries.back().size;
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
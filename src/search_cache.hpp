@@ -0,0 +1,55 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+#include "search_results.hpp"
+
+// Results of recent searches in each document, forgetting the least recently used once full
+class SearchCache
+{
+public:
+    SearchCache();
+
+    // Marks the results as the most recently used, null if there are none for the document
+    const SearchResults* find(const string& documentName, const string& search, CaseMode caseMode);
+    // Meant for searches that were entered, not every prefix typed on the way to one
+    void insert(const string& documentName, const string& search, CaseMode caseMode, const SearchResults& results);
+    // Forgets a document's results once they no longer match its text
+    void erase(const string& documentName);
+
+private:
+    typedef tuple<string, string, CaseMode> Key;
+
+    struct Entry
+    {
+        Key key;
+        SearchResults results;
+        size_t size;
+    };
+
+    // Most recently used first
+    list<Entry> entries;
+    map<Key, list<Entry>::iterator> index;
+    // Bytes held by the results of every entry
+    size_t size;
+
+    void evict();
+};
@@ -0,0 +1,132 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "search_query.hpp"
+#include "constants.hpp"
+#include "regex.hpp"
+
+SearchQuery parseSearch(const string& search)
+{
+    if (search.starts_with(regexSearchPrefix))
+    {
+        return { SearchKind::Regex, search.substr(string_view(regexSearchPrefix).size()), 0 };
+    }
+
+    if (search.starts_with(fuzzySearchPrefix))
+    {
+        size_t offset = string_view(fuzzySearchPrefix).size();
+        i32 distance = defaultFuzzyDistance;
+
+        if (offset < search.size() && search.at(offset) >= '0' && search.at(offset) <= '9')
+        {
+            distance = search.at(offset) - '0';
+            offset++;
+        }
+
+        if (offset < search.size() && search.at(offset) == ':')
+        {
+            return { SearchKind::Fuzzy, search.substr(offset + 1), distance };
+        }
+    }
+
+    if (search.starts_with(phraseSearchQuote))
+    {
+        string pattern = search.substr(1);
+
+        // The closing quote is optional
+        if (pattern.ends_with(phraseSearchQuote))
+        {
+            pattern.pop_back();
+        }
+
+        return { SearchKind::Phrase, pattern, 0 };
+    }
+
+    vector<string> patterns;
+    string pattern;
+
+    for (size_t i = 0; i <= search.size(); i++)
+    {
+        if (i + 1 < search.size() && search.at(i) == searchEscape && search.at(i + 1) == multiplePatternSeparator)
+        {
+            pattern += multiplePatternSeparator;
+            i++;
+        }
+        else if (i < search.size() && search.at(i) != multiplePatternSeparator)
+        {
+            pattern += search.at(i);
+        }
+        // Empty literals match nothing, which also keeps a search being typed the same until the next one starts
+        else if (!pattern.empty())
+        {
+            patterns.push_back(pattern);
+            pattern.clear();
+        }
+    }
+
+    if (patterns.size() > 1)
+    {
+        return { SearchKind::Multiple, search, 0, patterns };
+    }
+    else if (patterns.size() == 1)
+    {
+        return { SearchKind::Literal, patterns.front(), 0 };
+    }
+
+    return { SearchKind::Literal, search, 0 };
+}
+
+string searchError(const SearchQuery& query)
+{
+    if (query.kind == SearchKind::Regex && !Regex(query.pattern, true).valid())
+    {
+        return "invalid regex";
+    }
+    else if (query.kind == SearchKind::Multiple && query.patterns.size() > maxSearchPatterns)
+    {
+        return format("more than {} patterns", maxSearchPatterns);
+    }
+
+    return "";
+}
+
+bool refines(const string& previous, const string& search)
+{
+    SearchQuery previousQuery = parseSearch(previous);
+    SearchQuery query = parseSearch(search);
+
+    return previousQuery.kind == SearchKind::Literal &&
+        query.kind == SearchKind::Literal &&
+        query.pattern.starts_with(previousQuery.pattern);
+}
+
+CaseMode caseModeFromEnvironment()
+{
+    const char* value = getenv(caseModeVariable);
+
+    if (value && string(value) == smartCaseMode)
+    {
+        return CaseMode::Smart;
+    }
+    else if (value && string(value) == ignoreCaseMode)
+    {
+        return CaseMode::Ignore;
+    }
+
+    return CaseMode::Sensitive;
+}
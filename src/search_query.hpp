@@ -0,0 +1,56 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_text.hpp"
+
+enum class SearchKind : u8
+{
+    Literal,
+    Regex,
+    Fuzzy,
+    // Several literals separated by |
+    Multiple,
+    // Words matched across line, block and page breaks
+    Phrase
+};
+
+struct SearchQuery
+{
+    SearchKind kind;
+    string pattern;
+    // Edits a fuzzy match may differ from the pattern by
+    i32 distance;
+    // Each literal of a multiple pattern search, in the order results are coloured by
+    vector<string> patterns;
+};
+
+/*
+ * Searches starting with the regex prefix are regular expressions, ~: or ~N: makes them fuzzy with a distance of
+ * N, a double quote makes them a phrase and anything else is matched literally, as several literals at once if it
+ * has more than one separated by |, where \| stands for | itself.
+ */
+SearchQuery parseSearch(const string& search);
+// Why the search can't be run, or empty if it can
+string searchError(const SearchQuery& query);
+// Whether the hits of previous contain every hit of search, so search only needs to check those
+bool refines(const string& previous, const string& search);
+// The case mode searches start with, from the environment
+CaseMode caseModeFromEnvironment();
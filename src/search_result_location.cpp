@@ -17,30 +17,30 @@ You should have received a copy of the GNU General Public License
 along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 */
 #include "search_result_location.hpp"
-#include "charwise.hpp"
 
 SearchResultLocation::SearchResultLocation(
-    const string& documentName,
     i32 pageIndex,
     i32 blockIndex,
     i32 characterIndex,
     i32 x,
-    i32 y
+    i32 y,
+    i32 length,
+    i32 pattern
 )
-    : documentName(documentName)
-    , pageIndex(pageIndex)
+    : pageIndex(pageIndex)
     , blockIndex(blockIndex)
     , characterIndex(characterIndex)
     , x(x)
     , y(y)
+    , length(length)
+    , pattern(pattern)
 {
 
 }
 
 bool SearchResultLocation::operator==(const SearchResultLocation& rhs) const
 {
-    return documentName == rhs.documentName &&
-        pageIndex == rhs.pageIndex &&
+    return pageIndex == rhs.pageIndex &&
         blockIndex == rhs.blockIndex &&
         characterIndex == rhs.characterIndex;
 }
@@ -130,7 +130,7 @@ strong_ordering SearchResultLocation::operator<=>(const SearchResultLocation& rh
     }
 }
 
-bool SearchResultLocation::overlap(const SearchResultLocation& other, const string& search) const
+bool SearchResultLocation::overlap(const SearchResultLocation& other) const
 {
-    return y == other.y && abs(other.x - x) < charwiseSize(search);
+    return y == other.y && x < other.x + other.length && other.x < x + length;
 }
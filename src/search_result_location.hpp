@@ -23,12 +23,13 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 struct SearchResultLocation
 {
     SearchResultLocation(
-        const string& documentName,
         i32 pageIndex,
         i32 blockIndex = 0,
         i32 characterIndex = 0,
         i32 x = 0,
-        i32 y = 0
+        i32 y = 0,
+        i32 length = 0,
+        i32 pattern = 0
     );
 
     bool operator==(const SearchResultLocation& rhs) const;
@@ -39,12 +40,17 @@ struct SearchResultLocation
     bool operator<=(const SearchResultLocation& rhs) const;
     strong_ordering operator<=>(const SearchResultLocation& rhs) const;
 
-    bool overlap(const SearchResultLocation& other, const string& search) const;
+    bool overlap(const SearchResultLocation& other) const;
 
-    string documentName;
     i32 pageIndex;
     i32 blockIndex;
     i32 characterIndex;
     i32 x;
     i32 y;
+    // Characters of the original text the match covers, which can differ from the search after normalization
+    i32 length;
+    // Which of a multiple pattern search's literals matched
+    i32 pattern;
+    // Where a match running past the end of its line carries on, on later rows, blocks or pages
+    vector<SearchResultLocation> continuations;
 };
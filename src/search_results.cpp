@@ -0,0 +1,155 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "search_results.hpp"
+
+SearchResults::SearchResults()
+{
+
+}
+
+void SearchResults::add(const SearchResultLocation& result)
+{
+    while (pageStarts.size() <= static_cast<size_t>(result.pageIndex))
+    {
+        pageStarts.push_back(size());
+    }
+
+    blockIndices.push_back(result.blockIndex);
+    characterIndices.push_back(result.characterIndex);
+    xs.push_back(result.x);
+    ys.push_back(result.y);
+    lengths.push_back(result.length);
+    patterns.push_back(result.pattern);
+
+    // Rows mostly come in order within a block, so this rarely moves more than a few indices
+    auto rowEnd = upper_bound(rowOrder.begin() + pageStarts.at(result.pageIndex), rowOrder.end(), result.y, [this](i32 row, u32 index) -> bool {
+        return row < ys.at(index);
+    });
+
+    rowOrder.insert(rowEnd, size() - 1);
+
+    for (const SearchResultLocation& continuation : result.continuations)
+    {
+        continuationOwners.push_back(size() - 1);
+        continuations.push_back(continuation);
+
+        auto continuationEnd = upper_bound(continuationOrder.begin(), continuationOrder.end(), continuation, [this](const SearchResultLocation& added, u32 index) -> bool {
+            return tuple(added.pageIndex, added.y) < tuple(continuations.at(index).pageIndex, continuations.at(index).y);
+        });
+
+        continuationOrder.insert(continuationEnd, continuations.size() - 1);
+    }
+}
+
+size_t SearchResults::size() const
+{
+    return xs.size();
+}
+
+bool SearchResults::empty() const
+{
+    return xs.empty();
+}
+
+SearchResultLocation SearchResults::at(size_t index) const
+{
+    return SearchResultLocation(
+        pageIndex(index),
+        blockIndices.at(index),
+        characterIndices.at(index),
+        xs.at(index),
+        ys.at(index),
+        lengths.at(index),
+        patterns.at(index)
+    );
+}
+
+i32 SearchResults::pageIndex(size_t index) const
+{
+    // Pages without results share a start with the next page, taking the last match skips them
+    return (upper_bound(pageStarts.begin(), pageStarts.end(), index) - pageStarts.begin()) - 1;
+}
+
+i32 SearchResults::pattern(size_t index) const
+{
+    return patterns.at(index);
+}
+
+size_t SearchResults::memorySize() const
+{
+    return sizeof(SearchResults) +
+        pageStarts.capacity() * sizeof(u32) +
+        blockIndices.capacity() * sizeof(u32) +
+        characterIndices.capacity() * sizeof(u32) +
+        xs.capacity() * sizeof(i32) +
+        ys.capacity() * sizeof(i32) +
+        lengths.capacity() * sizeof(i32) +
+        patterns.capacity() * sizeof(u8) +
+        rowOrder.capacity() * sizeof(u32) +
+        continuationOwners.capacity() * sizeof(u32) +
+        continuations.capacity() * sizeof(SearchResultLocation) +
+        continuationOrder.capacity() * sizeof(u32);
+}
+
+tuple<size_t, size_t> SearchResults::pageRange(i32 pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= static_cast<i32>(pageStarts.size()))
+    {
+        return { size(), size() };
+    }
+
+    return { pageStarts.at(pageIndex), pageIndex + 1 < static_cast<i32>(pageStarts.size()) ? pageStarts.at(pageIndex + 1) : size() };
+}
+
+vector<size_t> SearchResults::onRow(i32 pageIndex, i32 y) const
+{
+    auto [ first, last ] = pageRange(pageIndex);
+
+    auto begin = lower_bound(rowOrder.begin() + first, rowOrder.begin() + last, y, [this](u32 index, i32 row) -> bool {
+        return ys.at(index) < row;
+    });
+    auto end = upper_bound(begin, rowOrder.begin() + last, y, [this](i32 row, u32 index) -> bool {
+        return row < ys.at(index);
+    });
+
+    return vector<size_t>(begin, end);
+}
+
+vector<tuple<size_t, SearchResultLocation>> SearchResults::continuationsOnRow(i32 pageIndex, i32 y) const
+{
+    vector<tuple<size_t, SearchResultLocation>> found;
+
+    auto begin = lower_bound(continuationOrder.begin(), continuationOrder.end(), tuple(pageIndex, y), [this](u32 index, const tuple<i32, i32>& row) -> bool {
+        return tuple(continuations.at(index).pageIndex, continuations.at(index).y) < row;
+    });
+
+    for (auto it = begin; it != continuationOrder.end(); it++)
+    {
+        const SearchResultLocation& continuation = continuations.at(*it);
+
+        if (continuation.pageIndex != pageIndex || continuation.y != y)
+        {
+            break;
+        }
+
+        found.push_back({ continuationOwners.at(*it), continuation });
+    }
+
+    return found;
+}
@@ -0,0 +1,68 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "search_result_location.hpp"
+
+/*
+ * A document's search results stored as one array per field, with the range of results on each page kept
+ * instead of every result's page, so millions of hits stay small and seeding a position is a lookup.
+ */
+class SearchResults
+{
+public:
+    SearchResults();
+
+    // Results must be added in page and then grid order
+    void add(const SearchResultLocation& result);
+
+    size_t size() const;
+    bool empty() const;
+    // The result at index, without its continuations
+    SearchResultLocation at(size_t index) const;
+    i32 pageIndex(size_t index) const;
+    i32 pattern(size_t index) const;
+    // Bytes held, for keeping caches of results bounded
+    size_t memorySize() const;
+
+    // Indices of the first result on a page and just past its last one
+    tuple<size_t, size_t> pageRange(i32 pageIndex) const;
+    // Indices of the results on one row of a page
+    vector<size_t> onRow(i32 pageIndex, i32 y) const;
+    // Continuations on one row of a page and the index of the result each one belongs to
+    vector<tuple<size_t, SearchResultLocation>> continuationsOnRow(i32 pageIndex, i32 y) const;
+
+private:
+    // Index of each page's first result, pages after the last one with results are left out
+    vector<u32> pageStarts;
+    vector<u32> blockIndices;
+    vector<u32> characterIndices;
+    vector<i32> xs;
+    vector<i32> ys;
+    vector<i32> lengths;
+    vector<u8> patterns;
+    // Each page's result indices sorted by row, so a row's results are found without going through the page
+    vector<u32> rowOrder;
+    // Few results have continuations so they are stored apart along with the result they belong to
+    vector<u32> continuationOwners;
+    vector<SearchResultLocation> continuations;
+    // Continuation indices sorted by page and row
+    vector<u32> continuationOrder;
+};
@@ -0,0 +1,450 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "search_text.hpp"
+#include "charwise.hpp"
+
+// Unicode simple case folding for the Latin, Greek and Cyrillic blocks, which keeps every character a single code point
+static constexpr i32 foldCase(i32 c)
+{
+    if ((c >= 'A' && c <= 'Z') || (c >= 0xc0 && c <= 0xde && c != 0xd7))
+    {
+        return c + 0x20;
+    }
+    else if (c == 0xb5)
+    {
+        return 0x3bc;
+    }
+    else if (c == 0x178)
+    {
+        return 0xff;
+    }
+    else if (c == 0x17f)
+    {
+        return 's';
+    }
+    else if ((c >= 0x100 && c <= 0x12f) || (c >= 0x132 && c <= 0x137) || (c >= 0x14a && c <= 0x177))
+    {
+        return c | 1;
+    }
+    else if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17e))
+    {
+        return c % 2 == 1 ? c + 1 : c;
+    }
+    else if (c == 0x386)
+    {
+        return 0x3ac;
+    }
+    else if (c >= 0x388 && c <= 0x38a)
+    {
+        return c + 0x25;
+    }
+    else if (c == 0x38c)
+    {
+        return 0x3cc;
+    }
+    else if (c == 0x38e || c == 0x38f)
+    {
+        return c + 0x3f;
+    }
+    else if (c >= 0x391 && c <= 0x3ab && c != 0x3a2)
+    {
+        return c + 0x20;
+    }
+    else if (c == 0x3c2)
+    {
+        return 0x3c3;
+    }
+    else if (c >= 0x400 && c <= 0x40f)
+    {
+        return c + 0x50;
+    }
+    else if (c >= 0x410 && c <= 0x42f)
+    {
+        return c + 0x20;
+    }
+    else if ((c >= 0x460 && c <= 0x481) || (c >= 0x48a && c <= 0x4bf) || (c >= 0x4d0 && c <= 0x52f))
+    {
+        return c | 1;
+    }
+    else if (c == 0x1e9e)
+    {
+        return 0xdf;
+    }
+    else if (c >= 0x1e00 && c <= 0x1eff && c != 0x1e9e && (c < 0x1e96 || c > 0x1e9f))
+    {
+        return c | 1;
+    }
+    else if (c == 0x2126)
+    {
+        return 0x3c9;
+    }
+    else if (c == 0x212a)
+    {
+        return 'k';
+    }
+    else if (c == 0x212b)
+    {
+        return 0xe5;
+    }
+    else if (c >= 0xff21 && c <= 0xff3a)
+    {
+        return c + 0x20;
+    }
+
+    return c;
+}
+
+
+// A compatibility form and the up to three plain code points searches should treat it as, NFKC-style
+static constexpr array<i32, 3> normalize(i32 c)
+{
+    switch (c)
+    {
+    // soft hyphen
+    case 0xad :
+        return { -1, -1, -1 };
+    // no-break and typographic spaces
+    case 0xa0 :
+    case 0x2000 :
+    case 0x2001 :
+    case 0x2002 :
+    case 0x2003 :
+    case 0x2004 :
+    case 0x2005 :
+    case 0x2006 :
+    case 0x2007 :
+    case 0x2008 :
+    case 0x2009 :
+    case 0x200a :
+    case 0x202f :
+    case 0x205f :
+        return { ' ', -1, -1 };
+    // superscript digits
+    case 0xb2 :
+        return { '2', -1, -1 };
+    case 0xb3 :
+        return { '3', -1, -1 };
+    case 0xb9 :
+        return { '1', -1, -1 };
+    // hyphens and dashes
+    case 0x2010 :
+    case 0x2011 :
+    case 0x2012 :
+    case 0x2013 :
+    case 0x2014 :
+    case 0x2015 :
+    case 0x2212 :
+        return { '-', -1, -1 };
+    // single quotes and primes
+    case 0x2018 :
+    case 0x2019 :
+    case 0x201a :
+    case 0x201b :
+    case 0x2032 :
+        return { '\'', -1, -1 };
+    // double quotes and primes
+    case 0x201c :
+    case 0x201d :
+    case 0x201e :
+    case 0x201f :
+    case 0x2033 :
+        return { '"', -1, -1 };
+    case 0x2026 :
+        return { '.', '.', '.' };
+    case 0xfb00 :
+        return { 'f', 'f', -1 };
+    case 0xfb01 :
+        return { 'f', 'i', -1 };
+    case 0xfb02 :
+        return { 'f', 'l', -1 };
+    case 0xfb03 :
+        return { 'f', 'f', 'i' };
+    case 0xfb04 :
+        return { 'f', 'f', 'l' };
+    case 0xfb05 :
+    case 0xfb06 :
+        return { 's', 't', -1 };
+    }
+
+    // superscript and subscript digits
+    if (c >= 0x2070 && c <= 0x2079 && c != 0x2071 && c != 0x2072 && c != 0x2073)
+    {
+        return { '0' + (c - 0x2070), -1, -1 };
+    }
+    else if (c >= 0x2080 && c <= 0x2089)
+    {
+        return { '0' + (c - 0x2080), -1, -1 };
+    }
+    // full-width ASCII
+    else if (c >= 0xff01 && c <= 0xff5e)
+    {
+        return { c - 0xfee0, -1, -1 };
+    }
+
+    return { c, -1, -1 };
+}
+
+// The UTF-8 form a character takes in search text
+struct Folding
+{
+    u8 size;
+    // Code points, only a single one of the same size as the original can be mapped byte for byte
+    u8 count;
+    char text[6];
+};
+
+static constexpr u8 unchangedSize = 0xff;
+
+template<i32 start, i32 end>
+static constexpr array<Folding, end - start> makeFoldingTable(bool caseFold)
+{
+    array<Folding, end - start> table{};
+
+    for (i32 c = start; c < end; c++)
+    {
+        Folding& folding = table[c - start];
+
+        array<i32, 3> normalized = normalize(c);
+
+        if (normalized[0] == c && (!caseFold || foldCase(c) == c))
+        {
+            folding.size = unchangedSize;
+            continue;
+        }
+
+        for (i32 codepoint : normalized)
+        {
+            if (codepoint < 0)
+            {
+                continue;
+            }
+
+            if (caseFold)
+            {
+                codepoint = foldCase(codepoint);
+            }
+
+            if (codepoint <= 0x7f)
+            {
+                folding.text[folding.size++] = codepoint;
+            }
+            else if (codepoint <= 0x7ff)
+            {
+                folding.text[folding.size++] = 0xc0 | (codepoint >> 6);
+                folding.text[folding.size++] = 0x80 | (codepoint & 0x3f);
+            }
+            else
+            {
+                folding.text[folding.size++] = 0xe0 | (codepoint >> 12);
+                folding.text[folding.size++] = 0x80 | ((codepoint >> 6) & 0x3f);
+                folding.text[folding.size++] = 0x80 | (codepoint & 0x3f);
+            }
+
+            folding.count++;
+        }
+    }
+
+    return table;
+}
+
+// Everything folding or normalization changes lies in these two ranges, generated at compile time
+static constexpr i32 lowTableEnd = 0x2200;
+static constexpr i32 highTableStart = 0xfb00;
+static constexpr i32 highTableEnd = 0xff60;
+
+static constexpr array<Folding, lowTableEnd> lowNormalizedTable = makeFoldingTable<0, lowTableEnd>(false);
+static constexpr array<Folding, lowTableEnd> lowFoldedTable = makeFoldingTable<0, lowTableEnd>(true);
+static constexpr array<Folding, highTableEnd - highTableStart> highNormalizedTable = makeFoldingTable<highTableStart, highTableEnd>(false);
+static constexpr array<Folding, highTableEnd - highTableStart> highFoldedTable = makeFoldingTable<highTableStart, highTableEnd>(true);
+
+static const Folding* findFolding(i32 c, bool caseFold)
+{
+    const Folding* folding = nullptr;
+
+    if (c >= 0 && c < lowTableEnd)
+    {
+        folding = &(caseFold ? lowFoldedTable : lowNormalizedTable)[c];
+    }
+    else if (c >= highTableStart && c < highTableEnd)
+    {
+        folding = &(caseFold ? highFoldedTable : highNormalizedTable)[c - highTableStart];
+    }
+
+    return folding && folding->size != unchangedSize ? folding : nullptr;
+}
+
+SearchText::SearchText()
+    : originalSize(0)
+{
+
+}
+
+void SearchText::append(string_view text)
+{
+    _text.reserve(_text.size() + text.size());
+
+    size_t offset = 0;
+
+    while (offset < text.size())
+    {
+        size_t size;
+        const Folding* folding = findFolding(decodeUTF8(text, offset, &size), true);
+
+        if (!folding)
+        {
+            _text.append(text.substr(offset, size));
+        }
+        else
+        {
+            if (folding->size != size || folding->count != 1)
+            {
+                irregulars.push_back({ _text.size(), folding->size, originalSize + offset, size });
+            }
+
+            _text.append(folding->text, folding->size);
+        }
+
+        offset += size;
+    }
+
+    originalSize += text.size();
+}
+
+const string& SearchText::text() const
+{
+    return _text;
+}
+
+size_t SearchText::originalStart(size_t offset) const
+{
+    auto it = upper_bound(irregulars.begin(), irregulars.end(), offset, [](size_t offset, const Irregular& irregular) -> bool {
+        return offset < irregular.offset;
+    });
+
+    if (it == irregulars.begin())
+    {
+        return offset;
+    }
+
+    const Irregular& irregular = *prev(it);
+
+    if (offset < irregular.offset + irregular.size)
+    {
+        return irregular.originalOffset;
+    }
+
+    return (offset - (irregular.offset + irregular.size)) + irregular.originalOffset + irregular.originalSize;
+}
+
+size_t SearchText::originalEnd(size_t offset) const
+{
+    auto it = lower_bound(irregulars.begin(), irregulars.end(), offset, [](const Irregular& irregular, size_t offset) -> bool {
+        return irregular.offset < offset;
+    });
+
+    if (it == irregulars.begin())
+    {
+        return offset;
+    }
+
+    const Irregular& irregular = *prev(it);
+
+    return (max(offset, irregular.offset + irregular.size) - (irregular.offset + irregular.size)) + irregular.originalOffset + irregular.originalSize;
+}
+
+size_t SearchText::size() const
+{
+    return _text.size() + irregulars.size() * sizeof(Irregular);
+}
+
+bool isUpperCase(i32 c)
+{
+    // Of the characters foldCase changes these are the only lower case ones: micro sign, long s and final sigma
+    if (c == 0xb5 || c == 0x17f || c == 0x3c2)
+    {
+        return false;
+    }
+
+    return foldCase(c) != c;
+}
+
+bool hasUpperCase(string_view s)
+{
+    size_t offset = 0;
+
+    while (offset < s.size())
+    {
+        size_t size;
+        i32 c = decodeUTF8(s, offset, &size);
+
+        if (c >= 0 && isUpperCase(c))
+        {
+            return true;
+        }
+
+        offset += size;
+    }
+
+    return false;
+}
+
+i32 normalizeCharacter(i32 c, bool caseFold)
+{
+    const Folding* folding = findFolding(c, caseFold);
+
+    if (!folding)
+    {
+        return c;
+    }
+    else if (folding->count != 1)
+    {
+        return -1;
+    }
+
+    size_t size;
+
+    return decodeUTF8(string_view(folding->text, folding->size), 0, &size);
+}
+
+string normalizeForSearch(string_view s, bool caseFold)
+{
+    string normalized;
+    normalized.reserve(s.size());
+
+    size_t offset = 0;
+
+    while (offset < s.size())
+    {
+        size_t size;
+        const Folding* folding = findFolding(decodeUTF8(s, offset, &size), caseFold);
+
+        if (!folding)
+        {
+            normalized.append(s.substr(offset, size));
+        }
+        else
+        {
+            normalized.append(folding->text, folding->size);
+        }
+
+        offset += size;
+    }
+
+    return normalized;
+}
@@ -0,0 +1,75 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+enum class CaseMode : u8
+{
+    Sensitive,
+    // Ignores case unless the search contains upper case characters
+    Smart,
+    Ignore
+};
+
+// A run of bytes in search text
+struct TextSpan
+{
+    size_t offset;
+    size_t size;
+};
+
+// A normalized, case-folded copy of a document's text that searches run against, mapped back to the original
+class SearchText
+{
+public:
+    SearchText();
+
+    // The text must start on a character boundary
+    void append(string_view text);
+
+    const string& text() const;
+    // Offset in the original text of the character the byte at offset was folded from
+    size_t originalStart(size_t offset) const;
+    // Offset in the original text just past the character the byte before offset was folded from
+    size_t originalEnd(size_t offset) const;
+
+    size_t size() const;
+
+private:
+    // A character that does not fold to a single character of the same size, everything between these maps one to one
+    struct Irregular
+    {
+        size_t offset;
+        size_t size;
+        size_t originalOffset;
+        size_t originalSize;
+    };
+
+    string _text;
+    size_t originalSize;
+    vector<Irregular> irregulars;
+};
+
+bool isUpperCase(i32 c);
+bool hasUpperCase(string_view s);
+// The single character c becomes in search text, or -1 if it expands to several or none
+i32 normalizeCharacter(i32 c, bool caseFold);
+// Expands ligatures and unifies compatibility forms, quotes, dashes and spaces, folding case too if asked
+string normalizeForSearch(string_view s, bool caseFold);
@@ -0,0 +1,144 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "substring_search.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NPDFR_X86
+#endif
+
+static size_t findScalar(string_view s, string_view search, size_t offset)
+{
+    return s.find(search, offset);
+}
+
+#ifdef NPDFR_X86
+/*
+ * Both kernels compare the first and last byte of the search against a
+ * whole register of candidate positions at once and only fall back to a
+ * full comparison where both match, which is rare in natural text
+ */
+__attribute__((target("sse2")))
+static size_t findSSE2(string_view s, string_view search, size_t offset)
+{
+    const char* data = s.data();
+    size_t size = s.size();
+    size_t searchSize = search.size();
+
+    __m128i first = _mm_set1_epi8(search.front());
+    __m128i last = _mm_set1_epi8(search.back());
+
+    size_t i = offset;
+
+    for (; i + searchSize - 1 + 16 <= size; i += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + searchSize - 1));
+
+        u32 mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(first, blockFirst),
+            _mm_cmpeq_epi8(last, blockLast)
+        ));
+
+        while (mask != 0)
+        {
+            u32 bit = __builtin_ctz(mask);
+
+            if (memcmp(data + i + bit + 1, search.data() + 1, searchSize - 2) == 0)
+            {
+                return i + bit;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return findScalar(s, search, i);
+}
+
+__attribute__((target("avx2")))
+static size_t findAVX2(string_view s, string_view search, size_t offset)
+{
+    const char* data = s.data();
+    size_t size = s.size();
+    size_t searchSize = search.size();
+
+    __m256i first = _mm256_set1_epi8(search.front());
+    __m256i last = _mm256_set1_epi8(search.back());
+
+    size_t i = offset;
+
+    for (; i + searchSize - 1 + 32 <= size; i += 32)
+    {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + searchSize - 1));
+
+        u32 mask = _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first, blockFirst),
+            _mm256_cmpeq_epi8(last, blockLast)
+        ));
+
+        while (mask != 0)
+        {
+            u32 bit = __builtin_ctz(mask);
+
+            if (memcmp(data + i + bit + 1, search.data() + 1, searchSize - 2) == 0)
+            {
+                return i + bit;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return findSSE2(s, search, i);
+}
+#endif
+
+typedef size_t (*SubstringSearchKernel)(string_view, string_view, size_t);
+
+static SubstringSearchKernel selectKernel()
+{
+#ifdef NPDFR_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return findAVX2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        return findSSE2;
+    }
+#endif
+
+    return findScalar;
+}
+
+size_t findSubstring(string_view s, string_view search, size_t offset)
+{
+    static const SubstringSearchKernel kernel = selectKernel();
+
+    if (search.size() < 2 || offset >= s.size())
+    {
+        return findScalar(s, search, offset);
+    }
+
+    return kernel(s, search, offset);
+}
@@ -0,0 +1,433 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "suffix_array.hpp"
+#include "constants.hpp"
+#include "index_cache.hpp"
+
+#include <unistd.h>
+
+// Laid out to be used straight from a mapping, followed by the suffixes and then the common prefix lengths
+struct SuffixArrayFileHeader
+{
+    char magic[8];
+    u32 version;
+    u32 padding;
+    u64 textSize;
+    u64 textHash;
+    u64 count;
+    // Hash of both arrays, back to back
+    u64 checksum;
+};
+
+/*
+ * Suffix array construction by induced sorting (SA-IS) as described by Nong,
+ * Zhang & Chan, symbols are stored as i32 and the last symbol of s must be a
+ * unique smallest sentinel
+ */
+static void getBuckets(const i32* s, vector<i32>& buckets, i32 n, i32 k, bool end)
+{
+    fill(buckets.begin(), buckets.end(), 0);
+
+    for (i32 i = 0; i < n; i++)
+    {
+        buckets[s[i]]++;
+    }
+
+    i32 sum = 0;
+
+    for (i32 i = 0; i <= k; i++)
+    {
+        sum += buckets[i];
+        buckets[i] = end ? sum : sum - buckets[i];
+    }
+}
+
+static void induceL(const vector<bool>& types, i32* sa, const i32* s, vector<i32>& buckets, i32 n, i32 k)
+{
+    getBuckets(s, buckets, n, k, false);
+
+    for (i32 i = 0; i < n; i++)
+    {
+        i32 j = sa[i] - 1;
+
+        if (j >= 0 && !types[j])
+        {
+            sa[buckets[s[j]]++] = j;
+        }
+    }
+}
+
+static void induceS(const vector<bool>& types, i32* sa, const i32* s, vector<i32>& buckets, i32 n, i32 k)
+{
+    getBuckets(s, buckets, n, k, true);
+
+    for (i32 i = n - 1; i >= 0; i--)
+    {
+        i32 j = sa[i] - 1;
+
+        if (j >= 0 && types[j])
+        {
+            sa[--buckets[s[j]]] = j;
+        }
+    }
+}
+
+static void sais(const i32* s, i32* sa, i32 n, i32 k)
+{
+    // true for S-type suffixes, false for L-type
+    vector<bool> types(n);
+
+    types[n - 1] = true;
+
+    for (i32 i = n - 2; i >= 0; i--)
+    {
+        types[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && types[i + 1]);
+    }
+
+    auto isLMS = [&types](i32 i) -> bool {
+        return i > 0 && types[i] && !types[i - 1];
+    };
+
+    vector<i32> buckets(k + 1);
+
+    // Sort the LMS substrings
+    getBuckets(s, buckets, n, k, true);
+    fill(sa, sa + n, -1);
+
+    for (i32 i = 1; i < n; i++)
+    {
+        if (isLMS(i))
+        {
+            sa[--buckets[s[i]]] = i;
+        }
+    }
+
+    induceL(types, sa, s, buckets, n, k);
+    induceS(types, sa, s, buckets, n, k);
+
+    i32 n1 = 0;
+
+    for (i32 i = 0; i < n; i++)
+    {
+        if (isLMS(sa[i]))
+        {
+            sa[n1++] = sa[i];
+        }
+    }
+
+    // Name the LMS substrings, equal substrings get equal names
+    fill(sa + n1, sa + n, -1);
+
+    i32 name = 0;
+    i32 previous = -1;
+
+    for (i32 i = 0; i < n1; i++)
+    {
+        i32 position = sa[i];
+        bool different = false;
+
+        for (i32 d = 0; d < n; d++)
+        {
+            if (
+                previous == -1 ||
+                s[position + d] != s[previous + d] ||
+                types[position + d] != types[previous + d]
+            )
+            {
+                different = true;
+                break;
+            }
+            else if (d > 0 && (isLMS(position + d) || isLMS(previous + d)))
+            {
+                break;
+            }
+        }
+
+        if (different)
+        {
+            name++;
+            previous = position;
+        }
+
+        sa[n1 + position / 2] = name - 1;
+    }
+
+    for (i32 i = n - 1, j = n - 1; i >= n1; i--)
+    {
+        if (sa[i] >= 0)
+        {
+            sa[j--] = sa[i];
+        }
+    }
+
+    // Sort the reduced string, recursing only if names are not yet unique
+    i32* sa1 = sa;
+    i32* s1 = sa + n - n1;
+
+    if (name < n1)
+    {
+        sais(s1, sa1, n1, name - 1);
+    }
+    else
+    {
+        for (i32 i = 0; i < n1; i++)
+        {
+            sa1[s1[i]] = i;
+        }
+    }
+
+    // Induce the full order from the sorted LMS suffixes
+    getBuckets(s, buckets, n, k, true);
+
+    for (i32 i = 1, j = 0; i < n; i++)
+    {
+        if (isLMS(i))
+        {
+            s1[j++] = i;
+        }
+    }
+
+    for (i32 i = 0; i < n1; i++)
+    {
+        sa1[i] = s1[sa1[i]];
+    }
+
+    fill(sa + n1, sa + n, -1);
+
+    for (i32 i = n1 - 1; i >= 0; i--)
+    {
+        i32 j = sa[i];
+        sa[i] = -1;
+        sa[--buckets[s[j]]] = j;
+    }
+
+    induceL(types, sa, s, buckets, n, k);
+    induceS(types, sa, s, buckets, n, k);
+}
+
+SuffixArray::SuffixArray(string_view text)
+{
+    i32 n = text.size() + 1;
+
+    // Shift bytes up by one to make room for the sentinel
+    vector<i32> s(n);
+
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        s[i] = static_cast<u8>(text[i]) + 1;
+    }
+
+    s[n - 1] = 0;
+
+    vector<i32> sa(n);
+
+    sais(s.data(), sa.data(), n, 256);
+
+    // The sentinel always sorts first
+    builtSuffixes.assign(sa.begin() + 1, sa.end());
+
+    s.clear();
+    s.shrink_to_fit();
+    sa.clear();
+    sa.shrink_to_fit();
+
+    // Kasai's algorithm
+    vector<u32> rank(text.size());
+
+    for (size_t i = 0; i < builtSuffixes.size(); i++)
+    {
+        rank[builtSuffixes[i]] = i;
+    }
+
+    builtLCP.assign(builtSuffixes.size(), 0);
+
+    size_t h = 0;
+
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (rank[i] == 0)
+        {
+            h = 0;
+            continue;
+        }
+
+        size_t j = builtSuffixes[rank[i] - 1];
+
+        while (i + h < text.size() && j + h < text.size() && text[i + h] == text[j + h])
+        {
+            h++;
+        }
+
+        builtLCP[rank[i]] = h;
+
+        if (h > 0)
+        {
+            h--;
+        }
+    }
+
+    suffixes = builtSuffixes;
+    lcp = builtLCP;
+}
+
+SuffixArray::SuffixArray(unique_ptr<MappedFile>&& file, span<const u32> suffixes, span<const u32> lcp)
+    : file(move(file))
+    , suffixes(suffixes)
+    , lcp(lcp)
+{
+
+}
+
+shared_ptr<const SuffixArray> SuffixArray::load(const filesystem::path& path, string_view text)
+{
+    unique_ptr<MappedFile> file = make_unique<MappedFile>(path);
+
+    if (!file->valid() || file->data().size() < sizeof(SuffixArrayFileHeader))
+    {
+        return nullptr;
+    }
+
+    SuffixArrayFileHeader header;
+    memcpy(&header, file->data().data(), sizeof(header));
+
+    string_view arrays = file->data().substr(sizeof(header));
+
+    if (memcmp(header.magic, indexFileMagic, sizeof(header.magic)) != 0 ||
+        header.version != indexFileVersion ||
+        header.textSize != text.size() ||
+        header.count != text.size() ||
+        arrays.size() != header.count * 2 * sizeof(u32))
+    {
+        return nullptr;
+    }
+
+    // A file saved for the same document extracted differently, or damaged since, is rebuilt
+    // Indices are only loaded off the UI thread, so the whole file is checked
+    if (header.textHash != hashBytes(text) || header.checksum != hashBytes(arrays))
+    {
+        return nullptr;
+    }
+
+    // The header keeps the arrays aligned within the page-aligned mapping
+    const u32* values = reinterpret_cast<const u32*>(arrays.data());
+
+    return shared_ptr<const SuffixArray>(new SuffixArray(
+        move(file),
+        span<const u32>(values, header.count),
+        span<const u32>(values + header.count, header.count)
+    ));
+}
+
+bool SuffixArray::save(const filesystem::path& path, string_view text) const
+{
+    string_view suffixBytes(reinterpret_cast<const char*>(suffixes.data()), suffixes.size_bytes());
+    string_view lcpBytes(reinterpret_cast<const char*>(lcp.data()), lcp.size_bytes());
+
+    SuffixArrayFileHeader header;
+    memcpy(header.magic, indexFileMagic, sizeof(header.magic));
+    header.version = indexFileVersion;
+    header.padding = 0;
+    header.textSize = text.size();
+    header.textHash = hashBytes(text);
+    header.count = suffixes.size();
+    header.checksum = hashBytes(hashBytes(suffixBytes), lcpBytes);
+
+    // Other processes and threads may be saving the same document at once
+    filesystem::path temporaryPath = path;
+    temporaryPath += format(".{}.{}", getpid(), hash<thread::id>()(this_thread::get_id()));
+
+    {
+        ofstream file(temporaryPath, ios::binary);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(suffixBytes.data(), suffixBytes.size());
+        file.write(lcpBytes.data(), lcpBytes.size());
+        file.close();
+
+        if (!file.good())
+        {
+            error_code error;
+            filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    error_code error;
+    filesystem::rename(temporaryPath, path, error);
+
+    if (error)
+    {
+        filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+vector<size_t> SuffixArray::find(string_view text, string_view search) const
+{
+    vector<size_t> offsets;
+
+    if (search.empty())
+    {
+        return offsets;
+    }
+
+    // Damage to a saved file that the checksum missed may lose hits but never crashes or invents them
+    auto at = [&text, &search](u32 suffix) -> string_view {
+        return text.substr(min<size_t>(suffix, text.size()), search.size());
+    };
+
+    auto first = lower_bound(suffixes.begin(), suffixes.end(), search, [&at](u32 suffix, string_view search) -> bool {
+        return at(suffix) < search;
+    });
+
+    if (first == suffixes.end() || at(*first) != search)
+    {
+        return offsets;
+    }
+
+    // Every following suffix sharing at least the whole search as a prefix is also a hit
+    size_t start = first - suffixes.begin();
+    size_t end = start + 1;
+
+    while (end < suffixes.size() && lcp[end] >= search.size())
+    {
+        end++;
+    }
+
+    offsets.reserve(end - start);
+
+    for (size_t i = start; i < end; i++)
+    {
+        if (at(suffixes[i]) == search)
+        {
+            offsets.push_back(suffixes[i]);
+        }
+    }
+
+    sort(offsets.begin(), offsets.end());
+
+    return offsets;
+}
+
+size_t SuffixArray::size() const
+{
+    return suffixes.size() * sizeof(u32) + lcp.size() * sizeof(u32);
+}
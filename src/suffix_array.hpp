@@ -0,0 +1,54 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+#include "mapped_file.hpp"
+
+class SuffixArray
+{
+public:
+    explicit SuffixArray(string_view text);
+    SuffixArray(const SuffixArray& rhs) = delete;
+    SuffixArray(SuffixArray&& rhs) = delete;
+
+    SuffixArray& operator=(const SuffixArray& rhs) = delete;
+    SuffixArray& operator=(SuffixArray&& rhs) = delete;
+
+    // Uses a saved index of text straight from the file, null if it is missing, of other text or corrupt
+    static shared_ptr<const SuffixArray> load(const filesystem::path& path, string_view text);
+    // Written to a temporary file and renamed into place so no process ever maps one half written
+    bool save(const filesystem::path& path, string_view text) const;
+
+    // Start offsets of every occurrence of search in text, including overlapping ones, in text order
+    vector<size_t> find(string_view text, string_view search) const;
+
+    size_t size() const;
+
+private:
+    // Holds the arrays when loaded, otherwise they are in builtSuffixes and builtLCP
+    unique_ptr<MappedFile> file;
+    vector<u32> builtSuffixes;
+    vector<u32> builtLCP;
+    span<const u32> suffixes;
+    // Length of the common prefix of each suffix and the one sorted before it
+    span<const u32> lcp;
+
+    SuffixArray(unique_ptr<MappedFile>&& file, span<const u32> suffixes, span<const u32> lcp);
+};
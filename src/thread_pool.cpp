@@ -0,0 +1,107 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : pending(0)
+    , stopping(false)
+{
+    threads.reserve(threadCount);
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.push_back(thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+
+        stopping = true;
+    }
+
+    taskReady.notify_all();
+
+    for (thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(function<void()>&& task)
+{
+    {
+        lock_guard<mutex> guard(lock);
+
+        tasks.push_back(move(task));
+        pending++;
+    }
+
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    unique_lock<mutex> guard(lock);
+
+    while (!tasks.empty())
+    {
+        function<void()> task = move(tasks.front());
+        tasks.pop_front();
+
+        guard.unlock();
+        task();
+        guard.lock();
+
+        pending--;
+    }
+
+    tasksDone.wait(guard, [this]() -> bool { return pending == 0; });
+}
+
+void ThreadPool::work()
+{
+    unique_lock<mutex> guard(lock);
+
+    while (true)
+    {
+        taskReady.wait(guard, [this]() -> bool { return stopping || !tasks.empty(); });
+
+        if (stopping)
+        {
+            return;
+        }
+
+        function<void()> task = move(tasks.front());
+        tasks.pop_front();
+
+        guard.unlock();
+        task();
+        guard.lock();
+
+        pending--;
+
+        if (pending == 0)
+        {
+            tasksDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,50 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+class ThreadPool
+{
+public:
+    explicit ThreadPool(size_t threadCount);
+    ThreadPool(const ThreadPool& rhs) = delete;
+    ThreadPool(ThreadPool&& rhs) = delete;
+    ~ThreadPool();
+
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+    ThreadPool& operator=(ThreadPool&& rhs) = delete;
+
+    // Tasks start in the order they are submitted
+    void submit(function<void()>&& task);
+    // Runs queued tasks on the calling thread too, returns once every submitted task has finished
+    void wait();
+
+private:
+    vector<thread> threads;
+
+    mutex lock;
+    condition_variable taskReady;
+    condition_variable tasksDone;
+    deque<function<void()>> tasks;
+    size_t pending;
+    bool stopping;
+
+    void work();
+};
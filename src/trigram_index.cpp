@@ -0,0 +1,162 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "trigram_index.hpp"
+
+static u32 trigramAt(string_view text, size_t offset)
+{
+    return (static_cast<u32>(static_cast<u8>(text[offset])) << 16) |
+        (static_cast<u32>(static_cast<u8>(text[offset + 1])) << 8) |
+        static_cast<u32>(static_cast<u8>(text[offset + 2]));
+}
+
+TrigramIndex::TrigramIndex()
+{
+
+}
+
+void TrigramIndex::addPage(i32 pageIndex, string_view text)
+{
+    vector<u32> trigrams;
+
+    if (text.size() >= 3)
+    {
+        trigrams.reserve(text.size() - 2);
+    }
+
+    for (size_t i = 0; i + 2 < text.size(); i++)
+    {
+        if (text[i] == '\0' || text[i + 1] == '\0' || text[i + 2] == '\0')
+        {
+            continue;
+        }
+
+        trigrams.push_back(trigramAt(text, i));
+    }
+
+    // Each distinct trigram only touches the map once per page
+    sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (u32 trigram : trigrams)
+    {
+        auto [it, inserted] = postings.try_emplace(trigram, Postings{ {}, -1 });
+
+        Postings& entry = it->second;
+
+        u32 gap = pageIndex - entry.lastPage;
+
+        while (gap >= 0x80)
+        {
+            entry.gaps.push_back(static_cast<u8>(gap | 0x80));
+            gap >>= 7;
+        }
+
+        entry.gaps.push_back(static_cast<u8>(gap));
+        entry.lastPage = pageIndex;
+    }
+}
+
+optional<vector<i32>> TrigramIndex::candidatePages(string_view search) const
+{
+    if (search.size() < 3)
+    {
+        return {};
+    }
+
+    vector<u32> trigrams;
+    trigrams.reserve(search.size() - 2);
+
+    for (size_t i = 0; i + 2 < search.size(); i++)
+    {
+        trigrams.push_back(trigramAt(search, i));
+    }
+
+    sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    // Intersecting the rarest trigrams first keeps the working set small
+    sort(trigrams.begin(), trigrams.end(), [this](u32 a, u32 b) -> bool {
+        auto aIt = postings.find(a);
+        auto bIt = postings.find(b);
+
+        size_t aSize = aIt != postings.end() ? aIt->second.gaps.size() : 0;
+        size_t bSize = bIt != postings.end() ? bIt->second.gaps.size() : 0;
+
+        return aSize < bSize;
+    });
+
+    vector<i32> pages = pagesOf(trigrams.front());
+
+    for (size_t i = 1; i < trigrams.size() && !pages.empty(); i++)
+    {
+        vector<i32> next = pagesOf(trigrams.at(i));
+        vector<i32> intersection;
+
+        set_intersection(pages.begin(), pages.end(), next.begin(), next.end(), back_inserter(intersection));
+
+        pages = move(intersection);
+    }
+
+    return pages;
+}
+
+size_t TrigramIndex::size() const
+{
+    size_t size = 0;
+
+    for (const auto& [trigram, entry] : postings)
+    {
+        size += sizeof(trigram) + sizeof(entry) + entry.gaps.size();
+    }
+
+    return size;
+}
+
+vector<i32> TrigramIndex::pagesOf(u32 trigram) const
+{
+    vector<i32> pages;
+
+    auto it = postings.find(trigram);
+
+    if (it == postings.end())
+    {
+        return pages;
+    }
+
+    i32 page = -1;
+    u32 gap = 0;
+    i32 shift = 0;
+
+    for (u8 byte : it->second.gaps)
+    {
+        gap |= static_cast<u32>(byte & 0x7f) << shift;
+        shift += 7;
+
+        if (!(byte & 0x80))
+        {
+            page += gap;
+            pages.push_back(page);
+
+            gap = 0;
+            shift = 0;
+        }
+    }
+
+    return pages;
+}
@@ -0,0 +1,48 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "types.hpp"
+
+// Maps every three byte sequence in a document to the pages it appears on
+class TrigramIndex
+{
+public:
+    TrigramIndex();
+
+    // Pages must be added in order, null bytes separate text that should not be joined into trigrams
+    void addPage(i32 pageIndex, string_view text);
+
+    // Pages that contain every trigram of search in ascending order, or nothing if search is too short to narrow down
+    optional<vector<i32>> candidatePages(string_view search) const;
+
+    size_t size() const;
+
+private:
+    struct Postings
+    {
+        // Gaps between consecutive page indices as variable length integers
+        vector<u8> gaps;
+        i32 lastPage;
+    };
+
+    unordered_map<u32, Postings> postings;
+
+    vector<i32> pagesOf(u32 trigram) const;
+};
@@ -19,10 +19,13 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <vector>
+#include <array>
 #include <format>
 #include <algorithm>
+#include <numeric>
 #include <iostream>
 #include <cstdlib>
 #include <csignal>
@@ -37,6 +40,19 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include <filesystem>
 #include <thread>
 #include <set>
+#include <deque>
+#include <list>
+#include <functional>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <span>
 
 using namespace std;
 
@@ -19,7 +19,7 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 #include "whitespace.hpp"
 #include "charwise.hpp"
 
-bool isWhitespace(const string& c)
+bool isWhitespace(string_view c)
 {
     return
         c == "\u0009" ||
@@ -79,19 +79,45 @@ bool isWhitespace(const string& c)
         c == "\ue0020";
 }
 
-string trimWhitespace(const string& s)
+string_view trimWhitespace(string_view s)
 {
-    vector<string> parts = splitUTF8(s);
+    size_t start = 0;
 
-    while (isWhitespace(parts.front()))
+    while (start < s.size())
     {
-        parts.erase(parts.begin());
+        size_t size = 1;
+
+        while (start + size < s.size() && !isPrimaryByte(s[start + size]))
+        {
+            size++;
+        }
+
+        if (!isWhitespace(s.substr(start, size)))
+        {
+            break;
+        }
+
+        start += size;
     }
 
-    while (isWhitespace(parts.back()))
+    size_t end = s.size();
+
+    while (end > start)
     {
-        parts.erase(parts.begin() + (parts.size() - 1));
+        size_t charStart = end - 1;
+
+        while (charStart > start && !isPrimaryByte(s[charStart]))
+        {
+            charStart--;
+        }
+
+        if (!isWhitespace(s.substr(charStart, end - charStart)))
+        {
+            break;
+        }
+
+        end = charStart;
     }
 
-    return joinUTF8(parts);
+    return s.substr(start, end - start);
 }
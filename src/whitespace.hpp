@@ -20,5 +20,6 @@ along with npdfr. If not, see <https://www.gnu.org/licenses/>.
 
 #include "types.hpp"
 
-bool isWhitespace(const string& c);
-string trimWhitespace(const string& s);
+bool isWhitespace(string_view c);
+// Returns a view into the input so callers can copy the result directly into its final storage
+string_view trimWhitespace(string_view s);
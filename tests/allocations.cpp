@@ -0,0 +1,113 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "types.hpp"
+#include "constants.hpp"
+#include "pdf_loader.hpp"
+
+// Checks that loading a document allocates each block's text once, in its page's arena, rather than once per copy
+
+// Page and document arenas take their buffers from the default resource, and so does text built without an arena's allocator
+class CountingResource : public pmr::memory_resource
+{
+public:
+    size_t allocatedBytes = 0;
+    // Arenas never ask for less than a page arena's initial size, so these were allocated outside of any arena
+    size_t smallAllocatedBytes = 0;
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override
+    {
+        allocatedBytes += size;
+
+        if (size < pageArenaInitialSize)
+        {
+            smallAllocatedBytes += size;
+        }
+
+        return pmr::new_delete_resource()->allocate(size, alignment);
+    }
+
+    void do_deallocate(void* p, size_t size, size_t alignment) override
+    {
+        pmr::new_delete_resource()->deallocate(p, size, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+static bool passed = true;
+
+static void check(bool condition, const string& message)
+{
+    if (!condition)
+    {
+        cerr << "FAILED: " << message << endl;
+        passed = false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        cerr << format("Usage: {} file", argv[0]) << endl;
+        return 1;
+    }
+
+    // Pages extracted in worker processes are rebuilt from a pipe, the path measured here is the one without them
+    unsetenv(workersVariable);
+
+    CountingResource counter;
+    pmr::memory_resource* previousResource = pmr::set_default_resource(&counter);
+
+    Document document = loadPDF(argv[1]);
+
+    pmr::set_default_resource(previousResource);
+
+    size_t blockCount = 0;
+    size_t textSize = 0;
+
+    for (const Page& page : document.pages())
+    {
+        for (const Block& block : page.blocks())
+        {
+            blockCount++;
+            textSize += block.text().size();
+
+            check(block.text().get_allocator().resource() == page.allocator().resource(), "block text is not in its page's arena");
+        }
+    }
+
+    cout << format(
+        "load: {} blocks with {} bytes of text, {} bytes taken by arenas and {} bytes allocated outside them",
+        blockCount,
+        textSize,
+        counter.allocatedBytes - counter.smallAllocatedBytes,
+        counter.smallAllocatedBytes
+    ) << endl;
+
+    check(blockCount > 0 && textSize > 0, "no text was loaded");
+    // Another copy of every block's text on the way into the arenas would cost at least the size of all of it
+    check(counter.smallAllocatedBytes < textSize, "load copies block text outside the arenas");
+
+    return passed ? 0 : 1;
+}
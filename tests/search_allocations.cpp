@@ -0,0 +1,118 @@
+/*
+Copyright 2024 Amini Allight
+
+This file is part of npdfr.
+
+npdfr is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+npdfr is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with npdfr. If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "types.hpp"
+#include "document.hpp"
+
+// Checks that searching allocates for the results it finds rather than for every block it looks at
+
+static constexpr i32 pageCount = 20;
+static constexpr i32 blocksPerPage = 200;
+
+static atomic<size_t> allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+
+    void* p = malloc(size);
+
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+static bool passed = true;
+
+static void check(bool condition, const string& message)
+{
+    if (!condition)
+    {
+        cerr << "FAILED: " << message << endl;
+        passed = false;
+    }
+}
+
+// Every block has the same text so the search indices stay small and allocate the same whatever the block count
+static Document buildDocument()
+{
+    Document document;
+    document.reserve(pageCount);
+
+    for (i32 pageIndex = 0; pageIndex < pageCount; pageIndex++)
+    {
+        Page page;
+        page.reserve(blocksPerPage);
+
+        for (i32 blockIndex = 0; blockIndex < blocksPerPage; blockIndex++)
+        {
+            f64 top = blockIndex * 40;
+
+            page.add(Block(0, 480, top, top + 30, "This block casts a fireball\nwith a text too long to fit in place\n", page.allocator()));
+        }
+
+        document.add(move(page));
+    }
+
+    document.generateGrid();
+
+    return document;
+}
+
+int main(int, char**)
+{
+    Document document = buildDocument();
+
+    size_t blockCount = pageCount * blocksPerPage;
+    size_t start = allocationCount;
+
+    SearchResults results = document.search("fireball");
+
+    size_t searchAllocations = allocationCount - start;
+
+    cout << format("search: {} allocations for {} results", searchAllocations, results.size()) << endl;
+
+    check(results.size() == blockCount, "search misses results");
+
+    start = allocationCount;
+
+    results = document.search("lightning");
+
+    size_t missAllocations = allocationCount - start;
+
+    cout << format("search without results: {} allocations", missAllocations) << endl;
+
+    // Blocks without a match must cost nothing, only the results themselves are allocated for
+    check(results.empty(), "search finds results that are not there");
+    check(missAllocations < blockCount, "search allocates per block");
+
+    return passed ? 0 : 1;
+}